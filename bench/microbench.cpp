@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <list>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "configreader.h"
+#include "process.h"
+#include "runqueue.h"
+#include "scheduler.h"
+#include "workload.h"
+
+// Microbenchmarks of the scheduler's hot paths, reported in ns per operation.
+// Each benchmark is calibrated until one repetition takes at least
+// MIN_REPETITION_NS, then run REPETITIONS times; the median is reported with
+// the fastest repetition and the spread (max - min) relative to the median.
+// Usage: microbench [substring of the benchmark names to run]
+
+static const int REPETITIONS = 9;
+static const double MIN_REPETITION_NS = 20e6;
+
+static volatile uint64_t sink;      // results the compiler must not discard
+static const char *filter = NULL;
+
+static double elapsedNs(std::chrono::steady_clock::time_point began)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - began).count();
+}
+
+// `body(n)` performs n operations
+template <typename Body>
+static void measure(const std::string& name, Body body)
+{
+    if (filter != NULL && name.find(filter) == std::string::npos)
+    {
+        return;
+    }
+    uint64_t n = 1;
+    double ns;
+    while (true)
+    {
+        std::chrono::steady_clock::time_point began = std::chrono::steady_clock::now();
+        body(n);
+        ns = elapsedNs(began);
+        if (ns >= MIN_REPETITION_NS)
+        {
+            break;
+        }
+        n = (ns < MIN_REPETITION_NS / 100) ? n * 10 : (uint64_t)(n * 1.2 * MIN_REPETITION_NS / ns) + 1;
+    }
+    std::vector<double> per_op(REPETITIONS);
+    int r;
+    for (r = 0; r < REPETITIONS; r++)
+    {
+        std::chrono::steady_clock::time_point began = std::chrono::steady_clock::now();
+        body(n);
+        per_op[r] = elapsedNs(began) / n;
+    }
+    std::sort(per_op.begin(), per_op.end());
+    double median = per_op[REPETITIONS / 2];
+    printf("| %-44s | %12.1lf | %12.1lf | %6.1lf%% |\n", name.c_str(), median, per_op[0],
+           100.0 * (per_op[REPETITIONS - 1] - per_op[0]) / median);
+    fflush(stdout);
+}
+
+static std::string writeWorkload(uint16_t num_processes, uint16_t num_bursts)
+{
+    return writeWorkload(defaultWorkload(num_processes, num_bursts));
+}
+
+static void benchReadConfig(uint16_t num_processes, uint16_t num_bursts)
+{
+    std::string path = writeWorkload(num_processes, num_bursts);
+    char name[64];
+    snprintf(name, sizeof(name), "readConfigFile %u procs x %u bursts", num_processes, num_bursts);
+    measure(name, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++)
+        {
+            SchedulerConfig *config = readConfigFile(path.c_str());
+            sink += config->num_processes;
+            deleteConfig(config);
+        }
+    });
+    unlink(path.c_str());
+}
+
+// updateProcess on a process with `num_bursts` bursts that has already been
+// dispatched once per burst (its wait history is that long)
+static void benchUpdateProcess(uint16_t num_bursts)
+{
+    std::string path = writeWorkload(1, num_bursts);
+    SchedulerConfig *config = readConfigFile(path.c_str());
+    unlink(path.c_str());
+    Process *p = createProcess(config, 0, 1);
+    uint32_t now = 1;
+    uint16_t i;
+    p->setState(Process::State::Ready, now);
+    for (i = 0; i < num_bursts; i++)
+    {
+        p->setState(Process::State::Running, now);
+        p->setState(Process::State::Ready, now);
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "updateProcess ready, %u bursts", num_bursts);
+    measure(name, [&](uint64_t n) {
+        for (uint64_t k = 0; k < n; k++)
+        {
+            p->updateProcess(++now);
+        }
+        sink += p->getWaitTime();
+    });
+
+    p->setState(Process::State::Running, now);
+    p->setSliceStartTime(now);
+    p->setBurstStartTime(now);
+    snprintf(name, sizeof(name), "updateProcess<RR> running, %u bursts", num_bursts);
+    uint32_t running = now;
+    measure(name, [&](uint64_t n) {
+        for (uint64_t k = 0; k < n; k++)
+        {
+            p->updateProcess<RoundRobinPolicy>(running + (uint32_t)(k & 7));
+        }
+        sink += p->getBurstTimeElapsed();
+    });
+    snprintf(name, sizeof(name), "updateProcess<FCFS> running, %u bursts", num_bursts);
+    measure(name, [&](uint64_t n) {
+        for (uint64_t k = 0; k < n; k++)
+        {
+            p->updateProcess<RunToCompletionPolicy>(running + (uint32_t)(k & 7));
+        }
+        sink += p->getBurstTimeElapsed();
+    });
+    delete p;
+    deleteConfig(config);
+}
+
+// A core taking the next process and the process going back after its slice,
+// with `queued` processes waiting
+static void benchReadyQueue(const SchedulerConfig *base, ScheduleAlgorithm algorithm)
+{
+    SchedulerConfig *config = deriveConfig(base, algorithm, base->cores, base->time_slice, base->context_switch);
+    SchedulerData *shared_data = createSchedulerData(config);
+    shared_data->virtual_clock = true;
+    shared_data->virtual_now = 1;
+    std::vector<Process*> processes;
+    int i;
+    for (i = 0; i < config->num_processes; i++)
+    {
+        processes.push_back(createProcess(config, i, 1));
+        launchProcess(shared_data, processes.back(), 1);
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "ready queue pop+push %s, %u queued", algorithmToString(algorithm).c_str(),
+             config->num_processes);
+    uint32_t slice = config->time_slice;
+    uint8_t cores = config->cores;
+    measure(name, [&](uint64_t n) {
+        for (uint64_t k = 0; k < n; k++)
+        {
+            Process *p = readyPop(shared_data, k % cores, NULL);
+            if (shared_data->cfs != NULL) shared_data->cfs->charge(p, slice);
+            if (shared_data->stride != NULL) shared_data->stride->charge(p, slice);
+            readyPush(shared_data, p);
+        }
+        sink += readySize(shared_data);
+    });
+
+    for (i = 0; i < (int)processes.size(); i++)
+    {
+        delete processes[i];
+    }
+    deleteSchedulerData(shared_data);
+    deleteConfig(config);
+}
+
+// std::list::sort of the ready queue: the shuffled queue, and the per-tick
+// re-sort of a queue that is already in order (what the SJF main loop does)
+template <typename Compare>
+static void benchSort(const char *comparator, const std::vector<Process*>& processes)
+{
+    std::vector<Process*> shuffled(processes);
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+    std::list<Process*> queue;
+    char name[64];
+    snprintf(name, sizeof(name), "list sort %s, %u shuffled", comparator, (unsigned)processes.size());
+    measure(name, [&](uint64_t n) {
+        for (uint64_t k = 0; k < n; k++)
+        {
+            queue.assign(shuffled.begin(), shuffled.end());
+            queue.sort(Compare());
+        }
+        sink += queue.size();
+    });
+    snprintf(name, sizeof(name), "list sort %s, %u in order", comparator, (unsigned)processes.size());
+    measure(name, [&](uint64_t n) {
+        for (uint64_t k = 0; k < n; k++)
+        {
+            queue.sort(Compare());
+        }
+        sink += queue.size();
+    });
+}
+
+// One acquire/release of the scheduler mutex as paid by each of `threads`
+// threads all hammering it (a short critical section, like a core's dispatch),
+// with or without --lock-stats recording
+static void benchMutex(uint32_t threads, bool recording)
+{
+    SchedulerData *shared_data = new SchedulerData();
+    shared_data->mutex.enableStats(recording);
+    char name[64];
+    snprintf(name, sizeof(name), "mutex %s, %u contending threads", recording ? "recorded" : "lock+unlock",
+             threads);
+    measure(name, [&](uint64_t n) {
+        std::atomic<uint32_t> ready(0);
+        std::vector<std::thread> workers;
+        uint64_t counter = 0;
+        uint32_t t;
+        for (t = 0; t < threads; t++)
+        {
+            workers.push_back(std::thread([&]() {
+                ready++;
+                while (ready < threads) std::this_thread::yield();
+                for (uint64_t k = 0; k < n; k++)
+                {
+                    SiteLock lock(shared_data->mutex, LockSite::LockDispatch);
+                    counter++;
+                }
+            }));
+        }
+        for (t = 0; t < threads; t++)
+        {
+            workers[t].join();
+        }
+        sink += counter;
+    });
+    delete shared_data;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        filter = argv[1];
+    }
+    printf("| %-44s | %12s | %12s | %7s |\n", "Benchmark", "ns/op", "min ns/op", "spread");
+    printf("+----------------------------------------------+--------------+--------------+---------+\n");
+
+    benchReadConfig(100, 11);
+    benchReadConfig(10000, 11);
+
+    uint16_t bursts[] = {1, 11, 101, 1001};
+    size_t b;
+    for (b = 0; b < sizeof(bursts) / sizeof(bursts[0]); b++)
+    {
+        benchUpdateProcess(bursts[b]);
+    }
+
+    std::string path = writeWorkload(1000, 11);
+    SchedulerConfig *base = readConfigFile(path.c_str());
+    unlink(path.c_str());
+    int a;
+    for (a = 0; a < NUM_ALGORITHMS; a++)
+    {
+        benchReadyQueue(base, (ScheduleAlgorithm)a);
+    }
+
+    // (created as PP processes so they keep their priorities)
+    SchedulerConfig *pp = deriveConfig(base, ScheduleAlgorithm::PP, base->cores, base->time_slice,
+                                       base->context_switch);
+    std::vector<Process*> processes;
+    int i;
+    for (i = 0; i < base->num_processes; i++)
+    {
+        processes.push_back(createProcess(pp, i, 1));
+    }
+    benchSort<SjfComparator>("SJF", processes);
+    benchSort<PpComparator>("PP", processes);
+    benchSort<PredictedComparator>("PSJF", processes);
+    benchSort<SrtfComparator>("SRTF", processes);
+    benchSort<EdfComparator>("EDF", processes);
+    benchSort<CfsComparator>("CFS", processes);
+    benchSort<StrideComparator>("STRIDE", processes);
+    for (i = 0; i < (int)processes.size(); i++)
+    {
+        delete processes[i];
+    }
+    deleteConfig(pp);
+    deleteConfig(base);
+
+    uint32_t threads[] = {1, 2, 4, 8, 16};
+    size_t t;
+    for (t = 0; t < sizeof(threads) / sizeof(threads[0]); t++)
+    {
+        benchMutex(threads[t], false);
+        benchMutex(threads[t], true);
+    }
+    return 0;
+}
@@ -0,0 +1,473 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "configreader.h"
+#include "process.h"
+#include "report.h"
+#include "simulator.h"
+#include "workload.h"
+
+// End-to-end simulator benchmark: generated workloads of increasing size run
+// through every algorithm, reporting scheduling events per wall-clock second,
+// peak RSS and the time of each phase (parse, setup, simulate, report). Every
+// point runs in a child process so its peak RSS is its own. The results are
+// written as CSV; a previous file can be given as a baseline to compare
+// events/s against (exit status 1 if any point regressed past the tolerance).
+// Usage: simbench [--engine=virtual|realtime|all] [--algorithms=<list>] [--levels=<n>]
+//                 [--output=<file>] [--baseline=<file>] [--tolerance=<%>]
+
+// One benchmark point and its measurements
+typedef struct BenchSample {
+    std::string engine;
+    ScheduleAlgorithm algorithm;
+    uint16_t processes;
+    uint16_t bursts;
+    uint8_t cores;
+    uint64_t events;
+    double parse_ms;        // negative: not measured (real-time runs are timed as a whole)
+    double setup_ms;
+    double simulate_ms;
+    double report_ms;
+    long peak_rss_kb;
+    bool ok;
+} BenchSample;
+
+// What a virtual-time child sends back through its pipe
+typedef struct ChildTimes {
+    uint64_t events;
+    double parse_ms;
+    double setup_ms;
+    double simulate_ms;
+    double report_ms;
+} ChildTimes;
+
+// Workload sizes (processes x bursts x cores), smallest first; arrivals are
+// spread so the cores stay about fully loaded whatever the size
+static const uint16_t LEVEL_PROCESSES[] = {100, 1000, 10000, 50000};
+static const uint16_t LEVEL_BURSTS[] = {11, 11, 21, 21};
+static const uint8_t LEVEL_CORES[] = {4, 8, 16, 32};
+static const int NUM_LEVELS = sizeof(LEVEL_PROCESSES) / sizeof(LEVEL_PROCESSES[0]);
+
+static double msSince(std::chrono::steady_clock::time_point began)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - began).count();
+}
+
+static WorkloadSpec levelWorkload(int level, ScheduleAlgorithm algorithm)
+{
+    WorkloadSpec spec = defaultWorkload(LEVEL_PROCESSES[level], LEVEL_BURSTS[level]);
+    spec.algorithm = algorithm;
+    spec.cores = LEVEL_CORES[level];
+    uint64_t cpu_ms = (uint64_t)spec.processes * ((spec.bursts + 1) / 2) * (spec.cpu_min + spec.cpu_max) / 2;
+    spec.arrival_span = cpu_ms / spec.cores;
+    return spec;
+}
+
+// A few processes with short bursts: the real-time engine runs 1 ms per ms
+static WorkloadSpec realtimeWorkload(ScheduleAlgorithm algorithm)
+{
+    WorkloadSpec spec = defaultWorkload(8, 5);
+    spec.algorithm = algorithm;
+    spec.cores = 2;
+    spec.arrival_span = 200;
+    spec.cpu_min = 20;
+    spec.cpu_max = 100;
+    spec.io_min = 20;
+    spec.io_max = 60;
+    return spec;
+}
+
+// Child side of a virtual-time point: every phase, timed
+static ChildTimes runVirtualChild(const std::string& path)
+{
+    ChildTimes times;
+    std::chrono::steady_clock::time_point began = std::chrono::steady_clock::now();
+    SchedulerConfig *config = readConfigFile(path.c_str());
+    times.parse_ms = msSince(began);
+
+    began = std::chrono::steady_clock::now();
+    SchedulerConfig *derived = deriveConfig(config, config->algorithm, config->cores, config->time_slice,
+                                            config->context_switch);
+    double derive_ms = msSince(began);
+    std::vector<Process*> processes;
+    SimulationResult result = simulate(derived, processes);
+    times.setup_ms = derive_ms + 1000.0 * result.setup_seconds;
+    times.simulate_ms = 1000.0 * result.run_seconds;
+    times.events = result.events;
+
+    began = std::chrono::steady_clock::now();
+    RunInfo info;
+    info.engine = "virtual";
+    info.deterministic = false;
+    info.config_file = path;
+    info.started_at = time(NULL);
+    info.wall_seconds = 0;
+    info.cores = derived->cores;
+    info.algorithm = derived->algorithm;
+    info.context_switch = derived->context_switch;
+    info.time_slice = derived->time_slice;
+    info.num_processes = derived->num_processes;
+    info.numa_nodes = derived->numa_nodes;
+    info.numa_policy = derived->numa_policy;
+    info.core_speeds = derived->core_speeds;
+    info.hetero_policy = derived->hetero_policy;
+    info.rr_adaptive = SliceMode::SliceStatic;
+    info.rr_target_overhead = derived->rr_target_overhead;
+    info.rr_target_response = derived->rr_target_response;
+    writeReport(ReportFormat::JsonReport, "/dev/null", info, result.summary, processes, result.start);
+    times.report_ms = msSince(began);
+    return times;
+}
+
+static BenchSample newSample(const std::string& engine, const WorkloadSpec& spec)
+{
+    BenchSample sample;
+    sample.engine = engine;
+    sample.algorithm = spec.algorithm;
+    sample.processes = spec.processes;
+    sample.bursts = spec.bursts;
+    sample.cores = spec.cores;
+    sample.events = 0;
+    sample.parse_ms = -1;
+    sample.setup_ms = -1;
+    sample.simulate_ms = -1;
+    sample.report_ms = -1;
+    sample.peak_rss_kb = 0;
+    sample.ok = false;
+    return sample;
+}
+
+static BenchSample runVirtual(const WorkloadSpec& spec)
+{
+    BenchSample sample = newSample("virtual", spec);
+    std::string path = writeWorkload(spec);
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        unlink(path.c_str());
+        return sample;
+    }
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fds[0]);
+        ChildTimes times = runVirtualChild(path);
+        ssize_t written = write(fds[1], &times, sizeof(times));
+        _exit(written == sizeof(times) ? 0 : 1);
+    }
+    close(fds[1]);
+    ChildTimes times;
+    bool received = (pid > 0 && read(fds[0], &times, sizeof(times)) == sizeof(times));
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    if (pid > 0 && wait4(pid, &status, 0, &usage) == pid && received && WIFEXITED(status) &&
+        WEXITSTATUS(status) == 0)
+    {
+        sample.events = times.events;
+        sample.parse_ms = times.parse_ms;
+        sample.setup_ms = times.setup_ms;
+        sample.simulate_ms = times.simulate_ms;
+        sample.report_ms = times.report_ms;
+        sample.peak_rss_kb = usage.ru_maxrss;
+        sample.ok = true;
+    }
+    unlink(path.c_str());
+    return sample;
+}
+
+// Value of a "# name=value" line of a CSV report (0 if missing)
+static uint64_t reportValue(const std::string& path, const std::string& name)
+{
+    std::ifstream file(path.c_str());
+    std::string line;
+    std::string prefix = "# " + name + "=";
+    while (std::getline(file, line))
+    {
+        if (line.compare(0, prefix.size(), prefix) == 0)
+        {
+            return std::stoull(line.substr(prefix.size()));
+        }
+    }
+    return 0;
+}
+
+// Real-time points run the simulator binary itself, timed as a whole. Events
+// are counted as in the virtual engine: every arrival and i/o completion, and
+// a dispatch and a release per context switch.
+static BenchSample runRealtime(const WorkloadSpec& spec, const std::string& simulator)
+{
+    BenchSample sample = newSample("realtime", spec);
+    std::string path = writeWorkload(spec);
+    std::string report = path + ".csv";
+    std::string report_option = "--report-file=" + report;
+    std::chrono::steady_clock::time_point began = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        execl(simulator.c_str(), simulator.c_str(), path.c_str(), "--report=csv", report_option.c_str(),
+              (char *)NULL);
+        _exit(127);
+    }
+    int status = 0;
+    struct rusage usage;
+    if (pid > 0 && wait4(pid, &status, 0, &usage) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0)
+    {
+        sample.simulate_ms = msSince(began);
+        uint64_t switches = reportValue(report, "metrics.context_switches");
+        sample.events = spec.processes + 2 * switches + (uint64_t)spec.processes * (spec.bursts / 2);
+        sample.peak_rss_kb = usage.ru_maxrss;
+        sample.ok = true;
+    }
+    else
+    {
+        fprintf(stderr, "Error: %s failed on %s\n", simulator.c_str(), path.c_str());
+    }
+    unlink(report.c_str());
+    unlink(path.c_str());
+    return sample;
+}
+
+static std::string sampleKey(const BenchSample& s)
+{
+    std::ostringstream key;
+    key << s.engine << ',' << algorithmToString(s.algorithm) << ',' << s.processes << ',' << s.bursts << ','
+        << (unsigned)s.cores;
+    return key.str();
+}
+
+static double eventsPerSecond(const BenchSample& s)
+{
+    return (s.simulate_ms > 0) ? s.events / (s.simulate_ms / 1000.0) : 0.0;
+}
+
+// events/s of each point of a previous CSV, by point
+static std::map<std::string, double> readBaseline(const std::string& filename)
+{
+    std::map<std::string, double> baseline;
+    std::ifstream file(filename.c_str());
+    std::string line;
+    std::getline(file, line);   // header
+    while (std::getline(file, line))
+    {
+        std::vector<std::string> fields;
+        std::string field;
+        std::stringstream ss(line);
+        while (std::getline(ss, field, ','))
+        {
+            fields.push_back(field);
+        }
+        if (fields.size() >= 11)
+        {
+            baseline[fields[0] + ',' + fields[1] + ',' + fields[2] + ',' + fields[3] + ',' + fields[4]] =
+                std::stod(fields[10]);
+        }
+    }
+    return baseline;
+}
+
+static void putMs(FILE *file, double ms)
+{
+    if (ms >= 0) fprintf(file, ",%.3lf", ms);
+    else fprintf(file, ",");
+}
+
+static bool writeSamples(const std::string& filename, const std::vector<BenchSample>& samples)
+{
+    FILE *file = fopen(filename.c_str(), "w");
+    if (file == NULL)
+    {
+        return false;
+    }
+    fprintf(file, "engine,algorithm,processes,bursts,cores,events,parse_ms,setup_ms,simulate_ms,report_ms,"
+                  "events_per_s,peak_rss_kb\n");
+    size_t i;
+    for (i = 0; i < samples.size(); i++)
+    {
+        const BenchSample& s = samples[i];
+        fprintf(file, "%s,%llu", sampleKey(s).c_str(), (unsigned long long)s.events);
+        putMs(file, s.parse_ms);
+        putMs(file, s.setup_ms);
+        putMs(file, s.simulate_ms);
+        putMs(file, s.report_ms);
+        fprintf(file, ",%.0lf,%ld\n", eventsPerSecond(s), s.peak_rss_kb);
+    }
+    return fclose(file) == 0;
+}
+
+static void printMs(double ms)
+{
+    if (ms >= 0) printf(" %9.2lf |", ms);
+    else printf(" %9s |", "-");
+}
+
+static void printSample(const BenchSample& s, const std::map<std::string, double>& baseline)
+{
+    printf("| %8s | %9s | %5u | %6u | %5u | %10llu |", s.engine.c_str(), algorithmToString(s.algorithm).c_str(),
+           s.processes, s.bursts, s.cores, (unsigned long long)s.events);
+    printMs(s.parse_ms);
+    printMs(s.setup_ms);
+    printMs(s.simulate_ms);
+    printMs(s.report_ms);
+    printf(" %11.0lf | %8.1lf |", eventsPerSecond(s), s.peak_rss_kb / 1024.0);
+    std::map<std::string, double>::const_iterator base = baseline.find(sampleKey(s));
+    if (base != baseline.end() && base->second > 0)
+    {
+        printf(" %+7.1lf%% |\n", 100.0 * (eventsPerSecond(s) / base->second - 1.0));
+    }
+    else
+    {
+        printf(" %8s |\n", "-");
+    }
+    fflush(stdout);
+}
+
+static void printBenchUsage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --engine=virtual|realtime|all  engines to benchmark (default virtual)\n");
+    fprintf(stderr, "  --algorithms=<list>     algorithm names, comma separated (default all)\n");
+    fprintf(stderr, "  --levels=<n>            workload sizes to run, 1-%d (default 2)\n", NUM_LEVELS);
+    fprintf(stderr, "  --output=<file>         results CSV (default simbench.csv)\n");
+    fprintf(stderr, "  --baseline=<file>       earlier results CSV to compare events/s against\n");
+    fprintf(stderr, "  --tolerance=<%%>         slowdown that counts as a regression (default 10)\n");
+}
+
+int main(int argc, char **argv)
+{
+    bool run_virtual = true;
+    bool run_realtime = false;
+    std::vector<ScheduleAlgorithm> algorithms;
+    int levels = 2;
+    std::string output = "simbench.csv";
+    std::string baseline_file;
+    double tolerance = 10.0;
+    int i;
+    for (i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = (eq == std::string::npos) ? "" : arg.substr(eq + 1);
+        if (name == "--engine" && (value == "virtual" || value == "realtime" || value == "all"))
+        {
+            run_virtual = (value != "realtime");
+            run_realtime = (value != "virtual");
+        }
+        else if (name == "--algorithms")
+        {
+            std::string item;
+            std::stringstream ss(value);
+            while (std::getline(ss, item, ','))
+            {
+                ScheduleAlgorithm algorithm;
+                if (!parseAlgorithm(item, &algorithm))
+                {
+                    fprintf(stderr, "Error: unknown algorithm '%s'\n", item.c_str());
+                    return 2;
+                }
+                algorithms.push_back(algorithm);
+            }
+        }
+        else if (name == "--levels" && atoi(value.c_str()) >= 1 && atoi(value.c_str()) <= NUM_LEVELS)
+        {
+            levels = atoi(value.c_str());
+        }
+        else if (name == "--output" && !value.empty())
+        {
+            output = value;
+        }
+        else if (name == "--baseline" && !value.empty())
+        {
+            baseline_file = value;
+        }
+        else if (name == "--tolerance" && !value.empty())
+        {
+            tolerance = atof(value.c_str());
+        }
+        else
+        {
+            printBenchUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (algorithms.empty())
+    {
+        for (i = 0; i < NUM_ALGORITHMS; i++)
+        {
+            algorithms.push_back((ScheduleAlgorithm)i);
+        }
+    }
+    std::map<std::string, double> baseline;
+    if (!baseline_file.empty())
+    {
+        baseline = readBaseline(baseline_file);
+        if (baseline.empty())
+        {
+            fprintf(stderr, "Error: no results in %s\n", baseline_file.c_str());
+            return 2;
+        }
+    }
+    std::string program = argv[0];
+    size_t slash = program.rfind('/');
+    std::string simulator = ((slash == std::string::npos) ? std::string(".") : program.substr(0, slash)) +
+                            "/osscheduler";
+
+    printf("|   Engine | Algorithm | Procs | Bursts | Cores |     Events |  Parse ms |  Setup ms |"
+           "    Sim ms | Report ms |    Events/s | RSS (MB) |  vs base |\n");
+    printf("+----------+-----------+-------+--------+-------+------------+-----------+-----------+"
+           "-----------+-----------+-------------+----------+----------+\n");
+    std::vector<BenchSample> samples;
+    size_t a;
+    int level;
+    for (level = 0; run_virtual && level < levels; level++)
+    {
+        for (a = 0; a < algorithms.size(); a++)
+        {
+            samples.push_back(runVirtual(levelWorkload(level, algorithms[a])));
+            printSample(samples.back(), baseline);
+        }
+    }
+    for (a = 0; run_realtime && a < algorithms.size(); a++)
+    {
+        samples.push_back(runRealtime(realtimeWorkload(algorithms[a]), simulator));
+        printSample(samples.back(), baseline);
+    }
+
+    if (!writeSamples(output, samples))
+    {
+        fprintf(stderr, "Error: could not write %s\n", output.c_str());
+        return 2;
+    }
+    printf("Results written to %s\n", output.c_str());
+
+    int status = 0;
+    size_t s;
+    for (s = 0; s < samples.size(); s++)
+    {
+        std::map<std::string, double>::const_iterator base = baseline.find(sampleKey(samples[s]));
+        if (!samples[s].ok)
+        {
+            fprintf(stderr, "Failed: %s\n", sampleKey(samples[s]).c_str());
+            status = 1;
+        }
+        else if (base != baseline.end() && eventsPerSecond(samples[s]) < base->second * (1.0 - tolerance / 100.0))
+        {
+            fprintf(stderr, "Regression: %s %.0lf events/s, baseline %.0lf\n", sampleKey(samples[s]).c_str(),
+                    eventsPerSecond(samples[s]), base->second);
+            status = 1;
+        }
+    }
+    return status;
+}
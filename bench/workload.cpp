@@ -0,0 +1,47 @@
+#include <cstdio>
+#include <random>
+#include <unistd.h>
+#include "workload.h"
+
+// 4 RR cores, bursts of 10-1000 ms cpu and 100-500 ms i/o, arrivals over 10 s
+WorkloadSpec defaultWorkload(uint16_t processes, uint16_t bursts)
+{
+    WorkloadSpec spec;
+    spec.algorithm = ScheduleAlgorithm::RR;
+    spec.cores = 4;
+    spec.context_switch = 5;
+    spec.time_slice = 50;
+    spec.processes = processes;
+    spec.bursts = bursts;
+    spec.arrival_span = 10000;
+    spec.cpu_min = 10;
+    spec.cpu_max = 1000;
+    spec.io_min = 100;
+    spec.io_max = 500;
+    spec.seed = processes * 7919 + bursts;
+    return spec;
+}
+
+std::string writeWorkload(const WorkloadSpec& spec)
+{
+    char path[] = "/tmp/workloadXXXXXX";
+    int fd = mkstemp(path);
+    FILE *file = fdopen(fd, "w");
+    std::mt19937 random(spec.seed);
+    std::uniform_int_distribution<uint32_t> start(0, spec.arrival_span), cpu(spec.cpu_min, spec.cpu_max),
+        io(spec.io_min, spec.io_max), priority(0, 4), deadline(0, 20000);
+    fprintf(file, "%u\n%s\n%u\n%u\n%u\n", spec.cores, algorithmToString(spec.algorithm).c_str(),
+            spec.context_switch, spec.time_slice, spec.processes);
+    uint32_t i, j;
+    for (i = 0; i < spec.processes; i++)
+    {
+        fprintf(file, "%u,%u,", 1024 + i, start(random));
+        for (j = 0; j < spec.bursts; j++)
+        {
+            fprintf(file, (j == 0) ? "%u" : "|%u", (j % 2 == 0) ? cpu(random) : io(random));
+        }
+        fprintf(file, ",%u,%u\n", priority(random), deadline(random));
+    }
+    fclose(file);
+    return path;
+}
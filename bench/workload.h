@@ -0,0 +1,28 @@
+#ifndef __WORKLOAD_H_
+#define __WORKLOAD_H_
+
+#include <string>
+#include "configreader.h"
+
+// Synthetic workload for the benchmarks
+typedef struct WorkloadSpec {
+    ScheduleAlgorithm algorithm;
+    uint8_t cores;
+    uint32_t context_switch;
+    uint32_t time_slice;
+    uint16_t processes;
+    uint16_t bursts;            // odd: cpu and i/o alternate, ending on cpu
+    uint32_t arrival_span;      // start times are drawn from [0, arrival_span] ms
+    uint32_t cpu_min;           // cpu burst range (ms)
+    uint32_t cpu_max;
+    uint32_t io_min;            // i/o burst range (ms)
+    uint32_t io_max;
+    uint32_t seed;
+} WorkloadSpec;
+
+WorkloadSpec defaultWorkload(uint16_t processes, uint16_t bursts);
+// Writes a configuration file for `spec` (priorities and deadlines drawn too)
+// to a new temporary file and returns its name; the caller unlinks it
+std::string writeWorkload(const WorkloadSpec& spec);
+
+#endif // __WORKLOAD_H_
@@ -0,0 +1,89 @@
+#!/bin/sh
+# Golden-output check. Every configuration in golden/configs and resrc/ runs
+# in deterministic (virtual-time) mode; its CSV report and event trace must
+# match golden/expected byte for byte, and a second run must match the first.
+# A sweep of every algorithm must give the expected table with 1 and 4 worker
+# threads, and a run resumed from a checkpoint must end exactly like the
+# uninterrupted one. Run after a refactor to show it did not change behaviour; after an
+# intended change, regenerate the expected files with --update.
+# Usage: golden/check.sh [--update]
+
+cd "$(dirname "$0")/.." || exit 2
+SIM=bin/osscheduler
+EXPECTED=golden/expected
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+UPDATE=0
+[ "$1" = "--update" ] && UPDATE=1
+FAILED=0
+
+# compare <produced> <expected file name>
+compare()
+{
+    if [ $UPDATE -eq 1 ]; then
+        cp "$1" "$EXPECTED/$2"
+    elif ! cmp -s "$1" "$EXPECTED/$2"; then
+        echo "FAIL  $2"
+        diff "$EXPECTED/$2" "$1" | head -10
+        FAILED=1
+        return
+    fi
+    echo "ok    $2"
+}
+
+for config in resrc/*.txt golden/configs/*.txt; do
+    name=$(basename "$config" .txt)
+    for run in 1 2; do
+        $SIM "$config" --deterministic --report=csv --report-file="$OUT/$name.$run.csv" \
+            --trace="$OUT/$name.$run.trace" > /dev/null || { echo "FAIL  $config exited $?"; FAILED=1; }
+    done
+    if ! cmp -s "$OUT/$name.1.csv" "$OUT/$name.2.csv" || ! cmp -s "$OUT/$name.1.trace" "$OUT/$name.2.trace"; then
+        echo "FAIL  $name differs between two runs"
+        FAILED=1
+    fi
+    compare "$OUT/$name.1.csv" "$name.report.csv"
+    compare "$OUT/$name.1.trace" "$name.trace.csv"
+done
+
+# resume each run from a checkpoint taken part way through: same report, and
+# the trace from the checkpoint on
+for config in resrc/*.txt golden/configs/*.txt; do
+    name=$(basename "$config" .txt)
+    [ $UPDATE -eq 1 ] && break
+    rm -f "$OUT/$name.ckpt"
+    $SIM "$config" --deterministic --checkpoint="$OUT/$name.ckpt" --checkpoint-every=500 > /dev/null
+    if [ ! -f "$OUT/$name.ckpt" ]; then
+        echo "FAIL  $name wrote no checkpoint"
+        FAILED=1
+        continue
+    fi
+    $SIM "$config" --deterministic --restore="$OUT/$name.ckpt" --report=csv --report-file="$OUT/$name.r.csv" \
+        --trace="$OUT/$name.r.trace" > /dev/null 2>&1 || { echo "FAIL  $name restore exited $?"; FAILED=1; }
+    from=$(sed -n 2p "$OUT/$name.r.trace" | cut -d, -f1)
+    awk -F, -v from="$from" 'NR == 1 || $1 >= from' "$EXPECTED/$name.trace.csv" > "$OUT/$name.suffix"
+    if cmp -s "$OUT/$name.r.csv" "$EXPECTED/$name.report.csv" && cmp -s "$OUT/$name.r.trace" "$OUT/$name.suffix"; then
+        echo "ok    $name restored from a checkpoint"
+    else
+        echo "FAIL  $name differs after restoring a checkpoint"
+        FAILED=1
+    fi
+done
+
+for jobs in 1 4; do
+    $SIM resrc/rr.txt --sweep-algorithms=all --sweep-slices=20,100,400 --sweep-cores=1,2,4 \
+        --report=csv --report-file="$OUT/sweep.$jobs.csv" --jobs=$jobs > /dev/null 2>&1
+done
+if ! cmp -s "$OUT/sweep.1.csv" "$OUT/sweep.4.csv"; then
+    echo "FAIL  sweep differs between 1 and 4 worker threads"
+    FAILED=1
+fi
+compare "$OUT/sweep.1.csv" "sweep.csv"
+
+if [ $UPDATE -eq 1 ]; then
+    echo "Expected files written to $EXPECTED"
+elif [ $FAILED -ne 0 ]; then
+    echo "Golden check FAILED"
+    exit 1
+else
+    echo "Golden check passed"
+fi
@@ -0,0 +1,41 @@
+#ifndef __BUFFEREDWRITER_H_
+#define __BUFFEREDWRITER_H_
+
+#include <cstdio>
+#include <string>
+#include <cstdint>
+
+// Output stream with a large private buffer and hand-rolled number formatting,
+// so reports with millions of records cost one fwrite() per 64 KiB
+class BufferedWriter {
+private:
+    static const size_t CAPACITY = 1 << 16;
+    FILE *file;
+    bool owns_file;
+    char *buffer;
+    size_t length;
+    bool failed;
+
+    void reserve(size_t n);
+
+public:
+    BufferedWriter(FILE *file);
+    BufferedWriter(const std::string& filename);   // "-" writes to stdout
+    ~BufferedWriter();
+
+    bool isOpen() const;
+    bool flush();   // false if any write so far has failed
+
+    BufferedWriter& put(char c);
+    BufferedWriter& put(const char *str);
+    BufferedWriter& put(const std::string& str);
+    BufferedWriter& putUnsigned(uint64_t value);
+    BufferedWriter& putSigned(int64_t value);
+    BufferedWriter& putDouble(double value, int precision);
+    // 6 decimals; inf/nan (e.g. throughput of an empty half) has no JSON
+    // representation, so it becomes null in JSON and an empty CSV field
+    BufferedWriter& putMetric(double value, bool json);
+    BufferedWriter& putJsonString(const std::string& str);
+};
+
+#endif // __BUFFEREDWRITER_H_
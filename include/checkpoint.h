@@ -0,0 +1,76 @@
+#ifndef __CHECKPOINT_H_
+#define __CHECKPOINT_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include "configreader.h"
+
+class Process;
+
+// Binary image of a simulation's state. Fields are fixed-width integers and
+// doubles in host byte order with no padding; a process is written as its
+// index in the process table, and a container as its length followed by its
+// elements in order. A checkpoint file is a header (magic, version, the
+// fingerprint of the configuration it was taken from), the image, and an
+// FNV-1a checksum of the image.
+class CheckpointWriter {
+private:
+    std::string data;
+    std::map<const Process*, uint32_t> index;
+
+    void putBytes(const void *bytes, size_t length);
+
+public:
+    CheckpointWriter(const std::vector<Process*>& processes);
+
+    void putU8(uint8_t value);
+    void putU16(uint16_t value);
+    void putU32(uint32_t value);
+    void putU64(uint64_t value);
+    void putDouble(double value);
+    void putBool(bool value);
+    void putString(const std::string& value);
+    void putProcess(const Process *p);      // NULL allowed
+    const std::string& image() const;
+};
+
+// Reads an image written by CheckpointWriter. A read past the end or of an
+// unknown process marks the reader failed and returns 0 / NULL, so a caller
+// can read a whole structure and check ok() once.
+class CheckpointReader {
+private:
+    std::string data;
+    size_t offset;
+    bool failed;
+    const std::vector<Process*> *processes;
+
+    bool getBytes(void *bytes, size_t length);
+
+public:
+    CheckpointReader(const std::string& image, const std::vector<Process*>& processes);
+
+    uint8_t getU8();
+    uint16_t getU16();
+    uint32_t getU32();
+    uint64_t getU64();
+    double getDouble();
+    bool getBool();
+    std::string getString();
+    Process* getProcess();
+    void fail();
+    bool ok() const;
+    bool atEnd() const;
+};
+
+// Hash of everything a run's result depends on: the processes and the options
+uint64_t configFingerprint(const SchedulerConfig *config);
+// Replaces `filename` with a checkpoint of `image` (written to a temporary
+// file first, so a crash part way through leaves the previous checkpoint)
+bool writeCheckpointFile(const std::string& filename, uint64_t fingerprint, const std::string& image);
+// The image in `filename`; false (with a message in `error`) when the file is
+// missing, damaged or was taken from a different configuration
+bool readCheckpointFile(const std::string& filename, uint64_t fingerprint, std::string *image, std::string *error);
+
+#endif // __CHECKPOINT_H_
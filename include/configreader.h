@@ -6,8 +6,23 @@
 #include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <vector>
 
-enum ScheduleAlgorithm : uint8_t { FCFS, SJF, RR, PP };
+enum ScheduleAlgorithm : uint8_t { FCFS, SJF, RR, PP, MLFQ, CFS, EDF, STRIDE, LOTTERY, SRTF,
+                                    PSJF, PSRTF, HRRN };
+static const int NUM_ALGORITHMS = HRRN + 1;
+
+// How cores pick processes on a NUMA machine (list-backed ready queues only)
+enum NumaPolicy : uint8_t { NumaIgnore, NumaLocal, NumaBalance };
+
+// How work is matched to cores of different speeds
+enum HeteroPolicy : uint8_t { HeteroIgnore, HeteroFastest };
+
+// Order in which an i/o device serves its queue
+enum IoDiscipline : uint8_t { IoFifo, IoSstf, IoDeadline };
+
+// What the RR time slice is tuned toward while the simulation runs
+enum SliceMode : uint8_t { SliceStatic, SliceOverhead, SliceResponse };
 
 typedef struct ProcessDetails {
     uint16_t pid;
@@ -15,6 +30,9 @@ typedef struct ProcessDetails {
     uint16_t num_bursts;
     uint32_t *burst_times;
     uint8_t priority;
+    uint32_t deadline;      // optional column 5: ms after start_time the process must finish by (0 = none)
+    uint32_t shares;        // optional column 6: STRIDE/LOTTERY tickets (0 = derive from priority)
+    uint8_t home_node;      // optional column 7: NUMA node holding the process's memory (default pid % numa_nodes)
 } ProcessDetails;
 
 typedef struct SchedulerConfig {
@@ -24,9 +42,54 @@ typedef struct SchedulerConfig {
     uint32_t time_slice;
     uint16_t num_processes;
     ProcessDetails *processes;
+    bool owns_processes;        // false for a deriveConfig copy sharing its base's processes
+    std::vector<std::string> option_lines; // the "name=value" lines, as read
+    // optional "name=value" lines after the process list
+    uint8_t mlfq_levels;        // MLFQ: number of queue levels (1-32)
+    uint32_t mlfq_slice_factor; // MLFQ: time slice multiplier from one level to the next
+    uint32_t mlfq_boost;        // MLFQ: ms between moving everything back to the top level (0 = never)
+    bool mlfq_io_boost;         // MLFQ: promote a process one level when it returns from i/o
+    uint32_t cfs_latency;       // CFS: target latency in ms (default 4 * time_slice)
+    uint32_t cfs_min_granularity; // CFS: shortest slice in ms (default time_slice / 2)
+    uint64_t lottery_seed;      // LOTTERY: random seed (default 1)
+    double predict_alpha;       // PSJF/PSRTF: weight of the latest burst in the prediction (default 0.5)
+    uint32_t predict_initial;   // PSJF/PSRTF: prediction for a process's first burst in ms (default 1000)
+    uint32_t hrrn_epoch;        // HRRN: width in ms of the age buckets the ready queue is kept in (default 50)
+    uint32_t pp_aging;          // PP: ms in the ready queue that raise a process one priority level (0 = no aging)
+    uint32_t migration_penalty; // ms of cache refill when a process runs on a different core than last time (default 0)
+    uint32_t affinity;          // FCFS/SJF/RR: ready processes a core scans for one that last ran on it (0 = off)
+    uint8_t numa_nodes;         // NUMA: nodes the cores are split across (default 1 = flat machine)
+    uint8_t numa_cores_per_node; // NUMA: cores on each node (default cores / numa_nodes)
+    std::vector<uint32_t> numa_distance; // NUMA: nodes x nodes distances, row-major (default 10 local, 20 remote)
+    double numa_stretch;        // NUMA: run time added per unit of relative remote distance (default 0.5)
+    NumaPolicy numa_policy;     // NUMA: none, local (prefer home-node processes) or balance (home node only, steal after numa_steal)
+    uint32_t numa_steal;        // NUMA balance: ms a process waits before a core of another node may take it
+    std::vector<double> core_speeds; // work done per ms on each core (default 1.0; missing entries are 1.0)
+    HeteroPolicy hetero_policy; // none, or fastest (idle work goes to the fastest idle core, longest work first)
+    std::vector<IoDiscipline> io_devices; // one entry per i/o device: fifo, sstf or deadline (none = unlimited parallel i/o)
+    uint32_t io_deadline;       // deadline devices: ms a request may wait before it is served oldest-first (default 500)
+    uint32_t io_seek;           // ms to seek across the whole device (default 0 = position does not matter)
+    SliceMode rr_adaptive;      // RR: none, overhead (hold context switching at rr_target_overhead) or response (rr_target_response)
+    double rr_target_overhead;  // RR adaptive: fraction of busy core time spent context switching (default 0.05)
+    uint32_t rr_target_response; // RR adaptive: ms a ready process should wait for a core (default 100)
+    uint32_t rr_adapt_interval; // RR adaptive: ms between slice adjustments (default 250)
+    uint32_t rr_min_slice;      // RR adaptive: smallest slice (default max(1, context_switch))
+    uint32_t rr_max_slice;      // RR adaptive: largest slice (default 10 * time_slice)
 } SchedulerConfig;
 
 SchedulerConfig* readConfigFile(const char *filename);
+SchedulerConfig* deriveConfig(const SchedulerConfig *base, ScheduleAlgorithm algorithm, uint8_t cores,
+                              uint32_t time_slice, uint32_t context_switch);
+void jitterWorkload(SchedulerConfig *config, double jitter, uint64_t seed);
 void deleteConfig(SchedulerConfig *config);
+bool parseAlgorithm(const std::string& name, ScheduleAlgorithm *algorithm);
+bool usesPriority(ScheduleAlgorithm algorithm);
+bool isProportionalShare(ScheduleAlgorithm algorithm);
+bool isPredictive(ScheduleAlgorithm algorithm);
+std::string algorithmToString(ScheduleAlgorithm algorithm);
+std::string numaPolicyToString(NumaPolicy policy);
+std::string heteroPolicyToString(HeteroPolicy policy);
+std::string ioDisciplineToString(IoDiscipline discipline);
+std::string sliceModeToString(SliceMode mode);
 
 #endif // __CONFIGREADER_H_
\ No newline at end of file
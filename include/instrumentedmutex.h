@@ -0,0 +1,80 @@
+#ifndef __INSTRUMENTEDMUTEX_H_
+#define __INSTRUMENTEDMUTEX_H_
+
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+// Places in the real-time engine that take the scheduler mutex
+enum LockSite : uint8_t { LockDispatch, LockTerminate, LockBlock, LockRequeue, LockPreemptCheck,
+                          LockMainTick, LockRender, LockOther };
+static const int NUM_LOCK_SITES = LockOther + 1;
+
+// log2 buckets: bucket k counts durations in [2^k, 2^(k+1)) ns (bucket 0 also holds 0)
+static const int LOCK_HISTOGRAM_BUCKETS = 40;
+
+// What one call site saw of the mutex
+typedef struct LockSiteStats {
+    uint64_t acquisitions;
+    uint64_t contended;       // acquisitions that found the mutex held and had to wait
+    uint64_t wait_ns;
+    uint64_t wait_max_ns;
+    uint64_t hold_ns;
+    uint64_t hold_max_ns;
+    uint64_t wait_histogram[LOCK_HISTOGRAM_BUCKETS];   // contended acquisitions only
+    uint64_t hold_histogram[LOCK_HISTOGRAM_BUCKETS];
+} LockSiteStats;
+
+// std::mutex that can record, per call site, how often it is taken, how often
+// a taker had to wait, and wait and hold time histograms. Recording is off
+// until enableStats(); when off, lock() and unlock() cost one branch more
+// than std::mutex. The statistics are updated while the mutex is held, so
+// they need no synchronization of their own; read them once no other thread
+// uses the mutex. lock() / unlock() without a site count as LockOther, so the
+// class also works with std::lock_guard.
+class InstrumentedMutex {
+private:
+    std::mutex mutex;
+    bool recording;
+    LockSite holder;                                  // site holding the mutex
+    std::chrono::steady_clock::time_point acquired;   // when it took it
+    LockSiteStats sites[NUM_LOCK_SITES];
+
+public:
+    InstrumentedMutex();
+
+    void enableStats(bool enable);
+    bool statsEnabled() const;
+    void lock(LockSite site);
+    void lock();
+    void unlock();
+    const LockSiteStats& stats(LockSite site) const;
+};
+
+// Scoped lock of an InstrumentedMutex on behalf of `site`
+class SiteLock {
+private:
+    InstrumentedMutex& mutex;
+
+public:
+    SiteLock(InstrumentedMutex& mutex, LockSite site) : mutex(mutex)
+    {
+        mutex.lock(site);
+    }
+
+    ~SiteLock()
+    {
+        mutex.unlock();
+    }
+
+    SiteLock(const SiteLock&) = delete;
+    SiteLock& operator =(const SiteLock&) = delete;
+};
+
+std::string lockSiteToString(LockSite site);
+// Contention table per site (sites never taken are left out), then each
+// site's wait and hold histograms
+void printLockReport(const InstrumentedMutex& mutex);
+
+#endif // __INSTRUMENTEDMUTEX_H_
@@ -0,0 +1,76 @@
+#ifndef __IODEVICE_H_
+#define __IODEVICE_H_
+
+#include <deque>
+#include <cstdint>
+#include "configreader.h"
+#include "process.h"
+#include "checkpoint.h"
+
+// Results of one i/o device over a run
+typedef struct DeviceSummary {
+    IoDiscipline discipline;
+    uint32_t served;          // requests completed
+    double busy_time;         // seconds serving requests
+    double utilization;       // busy_time / run time
+    double mean_depth;        // time-weighted number of requests waiting (not in service)
+    uint32_t max_depth;
+    double mean_wait;         // ms a request waited before service
+    double max_wait;
+} DeviceSummary;
+
+// A single-server i/o device: one request in service at a time, the rest wait
+// in a queue served FIFO, shortest-seek-first (SSTF) or SSTF with a deadline
+// after which the oldest request goes next. Requests carry a track position
+// derived from the process and burst; seeking costs `seek` ms per full sweep.
+// All methods must be called with the scheduler mutex held.
+class IoDevice {
+private:
+    typedef struct IoRequest {
+        Process *process;
+        uint32_t queued;      // time the request was submitted
+        uint32_t position;    // track, 0 .. TRACKS - 1
+    } IoRequest;
+
+    IoDiscipline discipline;
+    uint32_t deadline;
+    uint32_t seek;
+    std::deque<IoRequest> queue;
+    IoRequest active;
+    bool busy;
+    uint32_t head;            // track under the head
+    uint32_t service_end;     // completion time of the active request
+
+    // statistics
+    uint32_t started;
+    uint32_t served;
+    uint64_t busy_ms;
+    uint64_t depth_area;      // integral of queue depth over time (ms)
+    uint32_t max_depth;
+    uint64_t wait_total;
+    uint32_t wait_max;
+    uint32_t first_time;
+    uint32_t last_change;
+
+    void account(uint32_t now);
+    size_t pick(uint32_t now) const;
+    void start(uint32_t now);
+
+public:
+    static const uint32_t TRACKS = 1000;
+
+    IoDevice(IoDiscipline discipline, uint32_t deadline, uint32_t seek);
+
+    void submit(Process *p, uint32_t now);
+    // the request in service if it is done by `now` (starting the next one
+    // at its completion time), else NULL
+    Process* complete(uint32_t now);
+    size_t depth() const;
+    // completion time of the request in service (UINT32_MAX when idle)
+    uint32_t busyUntil() const;
+    DeviceSummary summarize(uint32_t end_time) const;
+    void save(CheckpointWriter& out) const;
+    void load(CheckpointReader& in);
+};
+
+#endif // __IODEVICE_H_
@@ -0,0 +1,77 @@
+#ifndef __OPTIONS_H_
+#define __OPTIONS_H_
+
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include <vector>
+#include "configreader.h"
+
+enum ReportFormat : uint8_t { NoReport, JsonReport, CsvReport };
+
+// How a run advances time: in real time with a thread per core, or as a
+// virtual-time simulation on one thread
+enum Engine : uint8_t { RealTime, VirtualTime };
+
+// Parameter sweep: every combination of the lists (an empty list keeps the
+// configuration file's value), each run in virtual time
+typedef struct SweepSpec {
+    bool enabled;
+    std::vector<ScheduleAlgorithm> algorithms;
+    std::vector<uint32_t> cores;
+    std::vector<uint32_t> time_slices;
+    std::vector<uint32_t> context_switches;
+    uint32_t jobs;                // worker threads (0 = one per host cpu)
+} SweepSpec;
+
+// Several algorithms run side by side on the configuration's workload
+typedef struct CompareSpec {
+    bool enabled;
+    std::vector<ScheduleAlgorithm> algorithms;
+    bool baseline_set;
+    ScheduleAlgorithm baseline;   // the others are shown relative to it (default: the configured algorithm)
+} CompareSpec;
+
+// Monte Carlo replication: independently seeded virtual-time runs of the
+// configuration, summarized as means with 95% confidence intervals
+typedef struct ReplicateSpec {
+    uint32_t replicas;            // most replicas to run (0 = no replication)
+    uint32_t min_replicas;        // replicas run before the precision target is checked
+    uint64_t seed;                // replica r is seeded with seed + r
+    double jitter;                // each burst and arrival time scaled by a draw from [1 - jitter, 1 + jitter]
+    double precision;             // stop once every interval is within this fraction of its mean (0 = run all)
+} ReplicateSpec;
+
+// Virtual time: periodic snapshots of the whole simulation state, and a
+// restart from one
+typedef struct CheckpointSpec {
+    std::string file;             // replaced by each new checkpoint (empty = none)
+    uint32_t every;               // simulated ms between checkpoints
+    std::string restore;          // checkpoint to resume from (empty = start at the beginning)
+} CheckpointSpec;
+
+// Command line options (everything after the configuration file name)
+typedef struct RunOptions {
+    const char *config_file;
+    uint32_t sample_interval;     // time series window length in ms (0 = disabled)
+    uint32_t sample_capacity;     // number of windows kept in the ring buffer
+    std::string timeseries_file;  // CSV output for the time series
+    ReportFormat report;          // machine-readable results export
+    std::string report_file;      // "-" for stdout
+    Engine engine;
+    bool deterministic;           // virtual time, and no wall-clock values in the report
+    bool seed_set;
+    uint64_t seed;                // overrides the configuration's random seed (lottery_seed)
+    std::string trace_file;       // virtual time: CSV of every event in order (empty = none)
+    double speed;                 // real time: simulated ms per wall-clock ms
+    bool lock_stats;              // real time: contention report for the scheduler mutex
+    SweepSpec sweep;
+    CompareSpec compare;
+    ReplicateSpec replicate;
+    CheckpointSpec checkpoint;
+} RunOptions;
+
+bool parseOptions(int argc, char **argv, RunOptions *options);
+void printUsage(const char *program);
+
+#endif // __OPTIONS_H_
@@ -4,6 +4,9 @@
 #include "configreader.h"
 #include "vector"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 // Process class
 class Process {
 public:
@@ -17,11 +20,28 @@ private:
     uint32_t *burst_times;    // CPU/IO burst array of times (in ms)
     uint32_t *cpu_io_times;
     uint8_t priority;         // process priority (0-4)
+    uint32_t deadline;        // ms after start_time the process should terminate by (0 = none)
+    uint32_t tickets;         // proportional-share tickets
+    uint64_t pass;            // STRIDE pass value
+    double entitled_time;     // ms of cpu the process's tickets entitled it to while competing
+    double entitlement_mark;  // entitlement per ticket when it last started competing
+    double predicted_burst;   // exponential average of observed cpu bursts (ms)
+    double prediction_error;  // sum of |actual - predicted| over completed bursts (ms)
+    double prediction_relative_error; // sum of |actual - predicted| / actual
+    uint32_t predictions;     // number of completed bursts compared with a prediction
     State state;              // process state
     int8_t core;              // CPU core currently running on
+    int8_t last_core;         // CPU core the process last ran on (-1 = never ran)
+    uint32_t migrations;      // dispatches on a different core than the previous one
+    uint32_t migration_time;  // ms spent refilling caches after migrating
+    uint8_t home_node;        // NUMA node holding the process's memory
+    double run_rate;          // ms of work done per ms on the current core (< 1 when remote)
+    uint32_t local_time;      // ms on a core of the home node
+    uint32_t remote_time;     // ms on a core of another node
+    uint32_t io_wait_time;    // ms spent queued for an i/o device
     uint32_t turn_time;        // total time since 'launch' (until terminated)
     uint32_t wait_time;        // total time spent in ready queue
-    int32_t cpu_time;         // total time spent running on a CPU core
+    int32_t cpu_time;         // cpu work done (less than time on a core when that runs slower)
     int32_t remain_time;      // CPU time remaining until terminated
     uint32_t total_remain_time;
     uint32_t into_queue_time;
@@ -33,11 +53,13 @@ private:
     bool launched;
     bool fromRunningToReady;
     uint32_t waitTimeNow;
-    std::vector<uint32_t> wait_times;
-    int rrFlag;
-    uint32_t roundRobinStartTime;
-    uint32_t ppTime;
-    int ppFlag;
+    uint32_t past_wait_time;    // wait of the ready queue stays that have ended
+    uint32_t slice_start_time;  // time the process was last dispatched (preemptible policies)
+    uint32_t completed_cpu_time; // cpu time of the bursts before the current one
+    uint32_t completion_time;   // actual time in ms (since epoch) that process terminated
+    uint32_t num_preemptions;   // times moved from running back to the ready queue
+    uint8_t queue_level;        // MLFQ level (0 = highest priority)
+    uint64_t vruntime;          // CFS virtual runtime (us of cpu time, weighted by priority)
     // you are welcome to add other private data fields here (e.g. actual time process was put in 
     // ready queue or i/o queue)
 
@@ -53,36 +75,101 @@ public:
     uint8_t getPriority() const;
     State getState() const;
     int8_t getCpuCore() const;
+    int8_t getLastCore() const;
+    uint32_t getNumMigrations() const;
+    double getMigrationTime() const;
+    uint8_t getHomeNode() const;
+    double getLocalTime() const;
+    double getRemoteTime() const;
+    double getCoreTime() const;
+    uint32_t getIntoQueueTime() const;
+    double getIoWaitTime() const;
+    uint32_t workIn(uint32_t ms) const;
     double getTurnaroundTime() const;
     double getWaitTime() const;
     double getCpuTime() const;
     double getRemainingTime() const;
     uint32_t getCurrentBurstTime() const;
+    uint32_t getBurstRemaining() const;
     bool isLaunched();
     uint16_t getCurrentBurst() const;
     uint32_t getBurstStartTime() const;
-    uint32_t getRoundRobinStartTime() const;
-    uint32_t getPPTime() const;
+    uint32_t getSliceStartTime() const;
+    uint32_t getLaunchTime() const;
+    uint32_t getCompletionTime() const;
+    uint32_t getNumPreemptions() const;
+    uint8_t getQueueLevel() const;
+    uint64_t getVruntime() const;
+    uint32_t getDeadline() const;
+    uint32_t getAbsoluteDeadline() const;
+    uint32_t getTickets() const;
+    uint64_t getPass() const;
+    double getEntitledTime() const;
+    double getPredictedBurst() const;
+    double getPredictedRemainingBurst() const;
+    double getPredictionError() const;
+    double getPredictionRelativeError() const;
+    uint32_t getNumPredictions() const;
 
     void setState(State new_state, uint32_t current_time);
     void setCpuCore(int8_t core_num);
+    void addMigration(uint32_t penalty);
+    void setRunRate(double rate);
+    void addCoreTime(uint32_t ms, bool local);
+    void addIoWait(uint32_t ms);
     void setIntoQueueTime(uint32_t current_time);
     void setBurstStartTime(uint32_t current_time);
     void setLaunched(bool set);
 
     void updateProcess(uint32_t current_time);
+    template <typename Policy> void updateProcess(uint32_t current_time);
     void updateBurstTime(int burst_idx, uint32_t new_time);
     void updateCurrentBurst();
     void setLastCpuTime(uint32_t current_time);
     void setLastWaitTime(uint32_t current_time);
     void setLaunchTime(uint32_t current_time);
     void resetBurstTimeElapsed();
-    void setRRFlag();
-    void setRoundRobinStartTime(uint32_t current_time);
-    void setPPTime(uint32_t current_time);
-    void setPPFlag();
+    void setSliceStartTime(uint32_t current_time);
+    void setQueueLevel(uint8_t level);
+    void setVruntime(uint64_t new_vruntime);
+    void setPass(uint64_t new_pass);
+    void startCompeting(double entitlement_per_ticket);
+    void stopCompeting(double entitlement_per_ticket);
+    void setPredictedBurst(double ms);
+    void observeBurst(uint32_t actual, double alpha);
+    // everything that changes as the process runs (checkpoint / restore)
+    void save(CheckpointWriter& out) const;
+    void load(CheckpointReader& in);
 };
 
+// Accounting for a process on a core, specialized per scheduling policy at
+// compile time. A policy that runs every cpu burst to completion measures
+// from the start of the burst; a preemptible one (Policy::preemptible) from
+// the start of the current slice plus the part of the burst run before it.
+// Time on the core counts at the core's run rate (slower on a remote node).
+template <typename Policy>
+inline void Process::updateProcess(uint32_t current_time)
+{
+    updateProcess(current_time);
+    if (state != State::Running){
+        return;
+    }
+    if (Policy::preemptible){
+        burstTimeElapsed = (cpu_io_times[current_burst] - burst_times[current_burst]) + workIn(current_time - slice_start_time);
+    }
+    else {
+        burstTimeElapsed = workIn(current_time - burstStartTime);
+    }
+    cpu_time = completed_cpu_time + burstTimeElapsed;
+    remain_time = total_remain_time - cpu_time;
+}
+
+// Work done in `ms` on the current core
+inline uint32_t Process::workIn(uint32_t ms) const
+{
+    return (run_rate == 1.0) ? ms : (uint32_t)(ms * run_rate);
+}
+
 // Comparators: used in std::list sort() method
 // No comparator needed for FCFS or RR (ready queue never sorted)
 struct SjfComparator {
@@ -93,4 +180,8 @@ struct PpComparator {
     bool operator ()(const Process *p1, const Process *p2);
 };
 
+struct PredictedComparator {
+    bool operator ()(const Process *p1, const Process *p2) const;
+};
+
 #endif // __PROCESS_H_
\ No newline at end of file
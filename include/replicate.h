@@ -0,0 +1,38 @@
+#ifndef __REPLICATE_H_
+#define __REPLICATE_H_
+
+#include <string>
+#include <vector>
+#include "configreader.h"
+#include "options.h"
+#include "report.h"
+
+// Estimate of one summary metric over the replicas
+typedef struct MetricInterval {
+    const char *name;
+    double mean;
+    double stddev;          // sample standard deviation
+    double half_width;      // 95% confidence interval is mean +/- half_width
+    double min;
+    double max;
+} MetricInterval;
+
+// Outcome of a replication run
+typedef struct ReplicationResult {
+    uint32_t replicas;      // replicas the estimates are over
+    uint32_t started;       // replicas simulated (the ones past the stopping point are discarded)
+    bool converged;         // every interval met the precision target
+    std::vector<MetricInterval> metrics;
+} ReplicationResult;
+
+// Runs seeded virtual-time replicas of `base` on a pool of `jobs` worker
+// threads. Replica r uses lottery_seed = seed + r and, with a jitter, its own
+// draw of the workload. With a precision target the run stops at the first
+// replica count n >= min_replicas whose intervals all meet it; replicas are
+// evaluated in seed order, so the result does not depend on `jobs`.
+ReplicationResult runReplicas(const SchedulerConfig *base, const ReplicateSpec& spec, uint32_t jobs);
+void printReplication(const ReplicateSpec& spec, const ReplicationResult& result);
+bool writeReplication(ReportFormat format, const std::string& filename, const ReplicateSpec& spec,
+                      const ReplicationResult& result);
+
+#endif // __REPLICATE_H_
@@ -0,0 +1,94 @@
+#ifndef __REPORT_H_
+#define __REPORT_H_
+
+#include <string>
+#include <vector>
+#include <ctime>
+#include "configreader.h"
+#include "options.h"
+#include "process.h"
+#include "iodevice.h"
+#include "slicetuner.h"
+
+// Outcome of the processes that have a deadline (lateness in ms, negative = finished early)
+typedef struct DeadlineSummary {
+    uint32_t with_deadline;
+    uint32_t misses;
+    double lateness_min;
+    double lateness_mean;
+    double lateness_p50;
+    double lateness_p90;
+    double lateness_p99;
+    double lateness_max;
+} DeadlineSummary;
+
+// Accuracy of the burst predictor (PSJF/PSRTF) over all completed cpu bursts
+typedef struct PredictionSummary {
+    uint32_t bursts;
+    double mean_abs_error;      // ms
+    double mean_rel_error;      // percent of the actual burst
+} PredictionSummary;
+
+// Aggregate results of one simulation run
+typedef struct RunSummary {
+    double runtime;             // seconds from process creation until all terminated
+    double cpu_percent;         // core time over run time (100% = one core busy throughout)
+    double core_time;           // seconds processes occupied a core
+    double work_time;           // seconds of cpu work done in it (differs on cores not at speed 1.0)
+    double overall_throughput;
+    double first_throughput;
+    double second_throughput;
+    double turn_avg;
+    double wait_avg;
+    double wait_p50;            // wait time percentiles over processes (seconds)
+    double wait_p99;
+    double wait_p999;
+    double wait_max;
+    uint32_t migrations;        // dispatches on a different core than the previous one
+    double migration_time;      // seconds of cache refill paid for them
+    double local_time;          // seconds processes ran on a core of their home NUMA node
+    double remote_time;         // seconds processes ran on a core of another node
+    DeadlineSummary deadlines;
+    PredictionSummary predictions;
+    std::vector<DeviceSummary> devices;   // empty when i/o is unlimited
+    uint64_t context_switches;  // processes that left a core
+    double switch_overhead;     // fraction of busy core time spent context switching
+    uint32_t final_slice;       // time slice in effect when the run ended (ms)
+    std::vector<SliceAdjustment> slice_adjustments;   // RR adaptive only
+} RunSummary;
+
+// Run metadata and the configuration that produced it
+typedef struct RunInfo {
+    std::string engine;
+    bool deterministic;         // leave out the wall-clock and host values, so reruns are byte-identical
+    std::string config_file;
+    time_t started_at;
+    double wall_seconds;
+    double speed;               // real time: simulated ms per wall-clock ms
+    uint8_t cores;
+    ScheduleAlgorithm algorithm;
+    uint32_t context_switch;
+    uint32_t time_slice;
+    uint16_t num_processes;
+    uint8_t numa_nodes;
+    NumaPolicy numa_policy;
+    std::vector<double> core_speeds;
+    HeteroPolicy hetero_policy;
+    SliceMode rr_adaptive;
+    double rr_target_overhead;
+    uint32_t rr_target_response;
+} RunInfo;
+
+RunSummary summarizeRun(const std::vector<Process*>& processes, uint32_t start, uint32_t half_time, uint32_t end_time);
+void printSummary(const RunSummary& summary);
+int64_t processLateness(const Process *p, uint32_t start);
+void printShares(const std::vector<Process*>& processes);
+void printDevices(const std::vector<DeviceSummary>& devices);
+void printSliceAdjustments(const RunInfo& info, const RunSummary& summary);
+double switchOverhead(const std::vector<Process*>& processes, uint64_t switches, uint32_t context_switch);
+
+// `start` is the time processes were created: per-process times are reported relative to it
+bool writeReport(ReportFormat format, const std::string& filename, const RunInfo& info,
+                 const RunSummary& summary, const std::vector<Process*>& processes, uint32_t start);
+
+#endif // __REPORT_H_
@@ -0,0 +1,282 @@
+#ifndef __RUNQUEUE_H_
+#define __RUNQUEUE_H_
+
+#include <deque>
+#include <vector>
+#include <set>
+#include <map>
+#include <random>
+#include "process.h"
+#include "checkpoint.h"
+
+// Ready queue structures for the algorithms that cannot use a single sorted std::list.
+// Each can save its contents, in order, to a checkpoint and load them into a
+// freshly constructed (empty) queue of the same configuration.
+
+// MLFQ - one FIFO per level plus a bitmask of non-empty levels, so push, pop
+// and "best waiting level" are all O(1) (level 0 is the highest priority)
+class MlfqQueue {
+private:
+    std::vector<std::deque<Process*> > levels;
+    uint32_t nonempty;    // bit i set when level i holds a process
+    size_t count;
+
+public:
+    MlfqQueue(uint8_t num_levels);
+
+    void push(Process *p);    // back of the process's current level
+    Process* pop();           // front of the highest non-empty level
+    int topLevel() const;     // highest non-empty level (-1 if empty)
+    size_t size() const;
+    uint8_t numLevels() const;
+    void boost();             // move every waiting process to level 0, keeping their order
+    void save(CheckpointWriter& out) const;
+    void load(CheckpointReader& in);
+};
+
+// CFS - load weight for a priority (0-4 map to nice -10, -5, 0, 5, 10)
+uint32_t cfsWeight(uint8_t priority);
+
+// CFS - orders the run queue by virtual runtime (pid breaks ties)
+struct CfsComparator {
+    bool operator ()(const Process *p1, const Process *p2) const;
+};
+
+// CFS - runnable processes in a red-black tree (std::set) keyed on vruntime:
+// O(log n) insert and pick-next, O(1) access to the leftmost process.
+// A process's vruntime only changes while it is outside the tree.
+class CfsRunQueue {
+private:
+    std::set<Process*, CfsComparator> tree;
+    uint64_t min_vruntime;    // never decreases: floor for placing woken processes
+    uint64_t queued_weight;   // load of the processes in the tree
+    uint64_t running_weight;  // load of the processes on a core
+    uint32_t latency;
+    uint32_t min_granularity;
+    uint8_t cores;
+
+public:
+    CfsRunQueue(uint32_t latency, uint32_t min_granularity, uint8_t cores);
+
+    void push(Process *p);
+    Process* pop();                     // leftmost; counts it as running
+    size_t size() const;
+    void place(Process *p, bool is_new);   // set vruntime of an arriving / waking process
+    void charge(Process *p, uint32_t ran); // process left its core after `ran` ms
+    uint32_t timeSlice(const Process *p) const;
+    bool shouldPreempt(const Process *p, uint32_t ran, uint32_t slice) const;
+    void save(CheckpointWriter& out) const;
+    void load(CheckpointReader& in);
+};
+
+// Ready queue kept in `Compare` order in a balanced tree: O(log n) insert and
+// pop, O(1) access to the best process. Keys must not change while queued.
+template <typename Compare>
+class OrderedQueue {
+private:
+    std::set<Process*, Compare> queue;
+
+public:
+    void push(Process *p)
+    {
+        queue.insert(p);
+    }
+
+    Process* pop()
+    {
+        if (queue.empty())
+        {
+            return NULL;
+        }
+        Process *p = *queue.begin();
+        queue.erase(queue.begin());
+        return p;
+    }
+
+    const Process* front() const
+    {
+        return queue.empty() ? NULL : *queue.begin();
+    }
+
+    size_t size() const
+    {
+        return queue.size();
+    }
+
+    void save(CheckpointWriter& out) const
+    {
+        out.putU32(queue.size());
+        typename std::set<Process*, Compare>::const_iterator it;
+        for (it = queue.begin(); it != queue.end(); it++)
+        {
+            out.putProcess(*it);
+        }
+    }
+
+    void load(CheckpointReader& in)
+    {
+        uint32_t n = in.getU32();
+        uint32_t i;
+        for (i = 0; i < n && in.ok(); i++)
+        {
+            Process *p = in.getProcess();
+            if (p != NULL) queue.insert(p);
+        }
+    }
+};
+
+// EDF - orders the ready queue by absolute deadline (pid breaks ties);
+// processes without a deadline sort after every process that has one
+struct EdfComparator {
+    bool operator ()(const Process *p1, const Process *p2) const;
+};
+
+typedef OrderedQueue<EdfComparator> EdfQueue;
+
+// SRTF - orders the ready queue by remaining cpu time (pid breaks ties)
+struct SrtfComparator {
+    bool operator ()(const Process *p1, const Process *p2) const;
+};
+
+typedef OrderedQueue<SrtfComparator> SrtfQueue;
+
+// PSJF/PSRTF - ready queue ordered by predicted remaining burst
+typedef OrderedQueue<PredictedComparator> PredictedQueue;
+
+// SRTF - the processes on the cores, keyed on dispatch time + remaining cpu
+// time. Every running process's remaining time shrinks at the same rate, so
+// the key stays valid while it runs and the largest key is always the core
+// with the longest remaining time: O(log cores) per preemption decision.
+class RunningSet {
+private:
+    std::set<std::pair<uint64_t, uint8_t> > running;
+    std::vector<uint64_t> keys;
+    std::vector<bool> present;
+    std::vector<bool> preempt;
+    size_t pending;     // cores flagged but not yet released
+
+public:
+    RunningSet(uint8_t cores);
+
+    void add(uint8_t core, uint32_t remaining, uint32_t now);
+    void remove(uint8_t core);     // also clears a pending preemption
+    // flag the core with the longest remaining time if `remaining` is shorter
+    // (only when every core is busy); returns the flagged core or -1
+    int preemptFor(uint32_t remaining, uint32_t now);
+    bool preemptRequested(uint8_t core) const;
+    void save(CheckpointWriter& out) const;
+    void load(CheckpointReader& in);
+};
+
+// STRIDE - orders the ready queue by pass value (pid breaks ties)
+struct StrideComparator {
+    bool operator ()(const Process *p1, const Process *p2) const;
+};
+
+// STRIDE - deterministic proportional share: the process with the lowest pass
+// runs next and its pass advances by its stride (inversely proportional to
+// its tickets) per ms of cpu. O(log n) insert and select.
+class StrideQueue {
+private:
+    std::set<Process*, StrideComparator> queue;
+    uint64_t min_pass;    // never decreases: floor for arriving / waking processes
+
+public:
+    StrideQueue();
+
+    void push(Process *p);
+    Process* pop();
+    size_t size() const;
+    void place(Process *p);                 // arriving or waking: no credit for time away
+    void charge(Process *p, uint32_t ran);  // process ran for `ran` ms
+    void save(CheckpointWriter& out) const;
+    void load(CheckpointReader& in);
+};
+
+// LOTTERY - randomized proportional share: each pop draws a winning ticket.
+// A Fenwick tree over ticket counts makes the draw O(log n).
+class LotteryQueue {
+private:
+    std::vector<Process*> slots;
+    std::vector<uint64_t> tree;       // Fenwick tree (1-based) of tickets per slot
+    std::vector<size_t> free_slots;
+    uint64_t total_tickets;
+    size_t count;
+    std::mt19937_64 random;
+
+    void add(size_t slot, int64_t tickets);
+    void grow();
+
+public:
+    LotteryQueue(uint64_t seed);
+
+    void push(Process *p);
+    Process* pop();
+    size_t size() const;
+    // the slot layout and the generator's state, so later draws pick the same winners
+    void save(CheckpointWriter& out) const;
+    void load(CheckpointReader& in);
+};
+
+// HRRN - highest response ratio (wait + service) / service next, with
+// service = remaining cpu time. Ratios change every ms, so instead of
+// re-sorting, processes are bucketed by the epoch in which they entered the
+// queue and each bucket is ordered by service. Nobody in a bucket has waited
+// longer than its oldest entry, so (now - oldest + service) / service bounds
+// the ratio of every entry from that one on: pop scans a bucket in service
+// order only while that bound beats the best ratio found,
+// and the choice is exact (ties go to the older bucket, then the shorter
+// service). Push is O(log n); pop is O(buckets) plus the entries whose bound
+// is not beaten, where buckets ~ longest wait / epoch.
+class HrrnQueue {
+private:
+    struct Entry {
+        uint32_t service;   // ms
+        uint32_t queued;    // time the process entered the queue
+        Process *process;
+        bool operator <(const Entry& other) const;
+    };
+    struct Bucket {
+        uint32_t oldest;    // no entry was queued earlier (kept when that entry leaves)
+        std::set<Entry> entries;
+    };
+    std::map<uint32_t, Bucket> buckets;     // keyed on queued / epoch
+    uint32_t epoch;
+    size_t count;
+
+public:
+    HrrnQueue(uint32_t epoch);
+
+    void push(Process *p, uint32_t now);
+    Process* pop(uint32_t now);
+    size_t size() const;
+    void save(CheckpointWriter& out) const;
+    void load(CheckpointReader& in);
+};
+
+// PP - one FIFO per priority level. With aging, a process's effective
+// priority improves by one level per `aging` ms spent waiting; the oldest
+// process of each level is always its best, so selection only compares the
+// level heads (O(levels)) and nothing is re-sorted as processes age.
+class AgingQueue {
+private:
+    std::vector<std::deque<std::pair<uint32_t, Process*> > > levels;
+    uint32_t aging;   // ms per level (0 = plain priority order)
+    size_t count;
+
+    int bestLevel(uint32_t now) const;
+    uint32_t effective(size_t level, uint32_t now) const;
+
+public:
+    AgingQueue(uint8_t num_levels, uint32_t aging);
+
+    void push(Process *p, uint32_t now);
+    Process* pop(uint32_t now);
+    // effective priority of the best waiting process (UINT32_MAX if empty)
+    uint32_t bestPriority(uint32_t now) const;
+    size_t size() const;
+    void save(CheckpointWriter& out) const;
+    void load(CheckpointReader& in);
+};
+
+#endif // __RUNQUEUE_H_
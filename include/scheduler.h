@@ -0,0 +1,651 @@
+#ifndef __SCHEDULER_H_
+#define __SCHEDULER_H_
+
+#include <iterator>
+#include <list>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include "configreader.h"
+#include "process.h"
+#include "runqueue.h"
+#include "topology.h"
+#include "iodevice.h"
+#include "slicetuner.h"
+#include "report.h"
+#include "instrumentedmutex.h"
+
+// Scheduler state and policies shared by the execution engines: the real-time
+// engine (one thread per core, wall clock) and the virtual-time simulator.
+
+// Shared data for all cores
+typedef struct SchedulerData {
+    InstrumentedMutex mutex;
+    std::condition_variable condition;
+    ScheduleAlgorithm algorithm;
+    uint32_t context_switch;
+    uint32_t time_slice;
+    std::list<Process*> ready_queue;
+    std::vector<Process*> terminated;
+    std::vector<Process*> io_q;         // processes doing i/o (queued or in service; a heap without devices)
+    bool all_terminated;
+    MlfqQueue *mlfq;
+    uint32_t mlfq_slice_factor;
+    uint32_t mlfq_boost;
+    bool mlfq_io_boost;
+    CfsRunQueue *cfs;
+    EdfQueue *edf;
+    StrideQueue *stride;
+    LotteryQueue *lottery;
+    SrtfQueue *srtf;
+    RunningSet *running;
+    PredictedQueue *predicted;
+    double predict_alpha;
+    HrrnQueue *hrrn;
+    AgingQueue *aging;
+    uint32_t migration_penalty;
+    uint32_t affinity;
+    Topology *topology;
+    NumaPolicy numa_policy;
+    uint32_t numa_steal;
+    HeteroPolicy hetero_policy;
+    std::vector<bool> idle;     // cores polling for work
+    std::vector<IoDevice*> devices;     // empty: unlimited parallel i/o
+    uint64_t switches;          // processes that have left a core (each costs a context switch)
+    SliceTuner *tuner;          // RR adaptive time slice (NULL = static)
+    double entitlement_per_ticket;  // proportional share: ms of cpu one ticket has been entitled to so far
+    uint32_t entitlement_time;  // when entitlement_per_ticket was last brought up to date
+    uint64_t competing_tickets; // tickets of the processes ready or running
+    uint32_t competing;         // number of processes ready or running
+    // ready queue hooks of the algorithm's policy, bound once by createSchedulerData
+    void (*ready_push)(struct SchedulerData *shared_data, Process *p);
+    Process* (*ready_pop)(struct SchedulerData *shared_data, uint8_t core_id, const Process *previous);
+    size_t (*ready_size)(const struct SchedulerData *shared_data);
+    bool virtual_clock;         // clockTime() is virtual_now rather than the wall clock
+    uint32_t virtual_now;
+} SchedulerData;
+
+SchedulerData* createSchedulerData(const SchedulerConfig *config);
+void deleteSchedulerData(SchedulerData *shared_data);
+// Runs the real-time engine's clock `speed` times faster than the wall clock
+// (call before any core thread starts). Everything the engine times -- arrivals,
+// bursts, slices, context switches, i/o -- and every statistic it reports are
+// then in simulated ms.
+void setClockSpeed(double speed);
+uint32_t currentTime();
+uint32_t clockTime(const SchedulerData *shared_data);
+Process* createProcess(const SchedulerConfig *config, int index, uint32_t start);
+void launchProcess(SchedulerData *shared_data, Process *p, uint32_t current_time);
+void mlfqBoost(SchedulerData *shared_data, std::vector<Process*>& processes);
+void finishSummary(SchedulerData *shared_data, const std::vector<Process*>& processes, uint32_t end_time,
+                   RunSummary *summary);
+void saveSchedulerData(const SchedulerData *shared_data, CheckpointWriter& out);
+bool loadSchedulerData(SchedulerData *shared_data, CheckpointReader& in);
+void readyPush(SchedulerData *shared_data, Process *p);
+Process* readyPop(SchedulerData *shared_data, uint8_t core_id, const Process *previous);
+size_t readySize(const SchedulerData *shared_data);
+std::list<Process*>::iterator readyPlace(SchedulerData *shared_data, uint8_t core_id, const Process *previous);
+size_t fasterIdleCores(SchedulerData *shared_data, uint8_t core_id);
+void readyArrived(SchedulerData *shared_data, Process *p, uint32_t current_time);
+uint32_t expectedMs(SchedulerData *shared_data, const Process *p);
+void burstFinished(SchedulerData *shared_data, Process *p);
+void ioSubmit(SchedulerData *shared_data, Process *p, uint32_t current_time);
+void ioComplete(SchedulerData *shared_data, uint32_t current_time, std::vector<Process*> *finished = NULL);
+uint32_t ioNextDone(const SchedulerData *shared_data);
+void ioFinished(SchedulerData *shared_data, Process *p, uint32_t current_time);
+uint32_t mlfqTimeSlice(SchedulerData *shared_data, uint8_t level);
+void startCompeting(SchedulerData *shared_data, Process *p, uint32_t now);
+void stopCompeting(SchedulerData *shared_data, Process *p, uint32_t now);
+
+// Per-core state a policy keeps for the process it is running
+typedef struct CoreState {
+    uint8_t core;
+    uint32_t slice;     // ms the current process may run before it yields
+} CoreState;
+
+// Scheduling policies for coreRunProcesses<Policy>. The algorithm is mapped to
+// a policy once at startup (selectCoreLoop, createSchedulerData), so each core
+// runs a loop with its policy's decisions inlined. A policy is a type with:
+//   preemptible   - a process can leave the core mid-burst (also selects the
+//                   accounting in Process::updateProcess<Policy>)
+//   locked_yield  - shouldYield reads shared state: call it with the mutex held
+//   create()      - allocate the algorithm's queues in fresh scheduler data
+//   push()        - put a process in the ready queue (mutex held)
+//   pop()         - take the process `core_id` should run next, or NULL (mutex held)
+//   size()        - number of processes in the ready queue (mutex held)
+//   dispatched()  - process was just taken from the ready queue (mutex held)
+//   shouldYield() - process must go back to the ready queue after `ran` ms
+//   requeue()     - process is about to go back to the ready queue (mutex held)
+//   stopped()     - process left the core after `ran` ms, for any reason (mutex held)
+// BasePolicy supplies no-op defaults and the list-backed ready queue; a new
+// policy hides only what it needs.
+struct BasePolicy {
+    static const bool preemptible = false;
+    static const bool locked_yield = false;
+
+    static void create(SchedulerData *shared_data, const SchedulerConfig *config)
+    {
+    }
+
+    static void push(SchedulerData *shared_data, Process *p)
+    {
+        shared_data->ready_queue.push_back(p);
+    }
+
+    static Process* pop(SchedulerData *shared_data, uint8_t core_id, const Process *previous)
+    {
+        std::list<Process*>::iterator it = readyPlace(shared_data, core_id, previous);
+        if (it == shared_data->ready_queue.end())
+        {
+            return NULL;
+        }
+        Process *p = *it;
+        shared_data->ready_queue.erase(it);
+        return p;
+    }
+
+    static size_t size(const SchedulerData *shared_data)
+    {
+        return shared_data->ready_queue.size();
+    }
+
+    static void dispatched(SchedulerData *shared_data, CoreState& core, Process *p)
+    {
+    }
+
+    static bool shouldYield(SchedulerData *shared_data, const CoreState& core, const Process *p, uint32_t ran)
+    {
+        return false;
+    }
+
+    static void requeue(SchedulerData *shared_data, const CoreState& core, Process *p, uint32_t ran)
+    {
+    }
+
+    static void stopped(SchedulerData *shared_data, const CoreState& core, Process *p, uint32_t ran)
+    {
+    }
+};
+
+// FCFS: every cpu burst runs to completion, in arrival order
+struct RunToCompletionPolicy : BasePolicy {
+};
+
+// SJF: run to completion, shortest remaining cpu time first. Remaining time
+// does not change while a process waits, so inserting each one after those
+// no longer than it keeps the list sorted (ties stay in arrival order).
+struct SjfPolicy : RunToCompletionPolicy {
+    static void push(SchedulerData *shared_data, Process *p)
+    {
+        std::list<Process*>& queue = shared_data->ready_queue;
+        std::list<Process*>::iterator it = queue.end();
+        while (it != queue.begin() && SjfComparator()(p, *std::prev(it)))
+        {
+            --it;
+        }
+        queue.insert(it, p);
+    }
+};
+
+// PSJF: run to completion, shortest predicted burst first
+struct PsjfPolicy : RunToCompletionPolicy {
+    static void create(SchedulerData *shared_data, const SchedulerConfig *config)
+    {
+        shared_data->predicted = new PredictedQueue();
+    }
+
+    static void push(SchedulerData *shared_data, Process *p)
+    {
+        shared_data->predicted->push(p);
+    }
+
+    static Process* pop(SchedulerData *shared_data, uint8_t core_id, const Process *previous)
+    {
+        return shared_data->predicted->pop();
+    }
+
+    static size_t size(const SchedulerData *shared_data)
+    {
+        return shared_data->predicted->size();
+    }
+};
+
+// HRRN: run to completion, highest response ratio first
+struct HrrnPolicy : RunToCompletionPolicy {
+    static void create(SchedulerData *shared_data, const SchedulerConfig *config)
+    {
+        shared_data->hrrn = new HrrnQueue(config->hrrn_epoch);
+    }
+
+    static void push(SchedulerData *shared_data, Process *p)
+    {
+        shared_data->hrrn->push(p, clockTime(shared_data));
+    }
+
+    static Process* pop(SchedulerData *shared_data, uint8_t core_id, const Process *previous)
+    {
+        return shared_data->hrrn->pop(clockTime(shared_data));
+    }
+
+    static size_t size(const SchedulerData *shared_data)
+    {
+        return shared_data->hrrn->size();
+    }
+};
+
+// RR: fixed (or adaptive) time slice over the list-backed ready queue
+struct RoundRobinPolicy : BasePolicy {
+    static const bool preemptible = true;
+
+    static void create(SchedulerData *shared_data, const SchedulerConfig *config)
+    {
+        if (config->rr_adaptive != SliceMode::SliceStatic)
+        {
+            shared_data->tuner = new SliceTuner(config);
+        }
+    }
+
+    static void dispatched(SchedulerData *shared_data, CoreState& core, Process *p)
+    {
+        core.slice = shared_data->time_slice;
+    }
+
+    static bool shouldYield(SchedulerData *shared_data, const CoreState& core, const Process *p, uint32_t ran)
+    {
+        return ran >= core.slice;
+    }
+};
+
+// LOTTERY: fixed time slice, the next process drawn by tickets
+struct LotteryPolicy : RoundRobinPolicy {
+    static void create(SchedulerData *shared_data, const SchedulerConfig *config)
+    {
+        shared_data->lottery = new LotteryQueue(config->lottery_seed);
+    }
+
+    static void push(SchedulerData *shared_data, Process *p)
+    {
+        shared_data->lottery->push(p);
+    }
+
+    static Process* pop(SchedulerData *shared_data, uint8_t core_id, const Process *previous)
+    {
+        return shared_data->lottery->pop();
+    }
+
+    static size_t size(const SchedulerData *shared_data)
+    {
+        return shared_data->lottery->size();
+    }
+};
+
+// STRIDE: round robin that advances the pass by the cpu actually used
+struct StridePolicy : RoundRobinPolicy {
+    static void create(SchedulerData *shared_data, const SchedulerConfig *config)
+    {
+        shared_data->stride = new StrideQueue();
+    }
+
+    static void push(SchedulerData *shared_data, Process *p)
+    {
+        shared_data->stride->push(p);
+    }
+
+    static Process* pop(SchedulerData *shared_data, uint8_t core_id, const Process *previous)
+    {
+        return shared_data->stride->pop();
+    }
+
+    static size_t size(const SchedulerData *shared_data)
+    {
+        return shared_data->stride->size();
+    }
+
+    static void stopped(SchedulerData *shared_data, const CoreState& core, Process *p, uint32_t ran)
+    {
+        shared_data->stride->charge(p, ran);
+    }
+};
+
+// MLFQ: slice grows with the level; a process that uses its whole slice is
+// demoted, one that gives up the cpu for i/o keeps its level
+struct MlfqPolicy : BasePolicy {
+    static const bool preemptible = true;
+    static const bool locked_yield = true;
+
+    static void create(SchedulerData *shared_data, const SchedulerConfig *config)
+    {
+        shared_data->mlfq = new MlfqQueue(config->mlfq_levels);
+    }
+
+    static void push(SchedulerData *shared_data, Process *p)
+    {
+        shared_data->mlfq->push(p);
+    }
+
+    static Process* pop(SchedulerData *shared_data, uint8_t core_id, const Process *previous)
+    {
+        return shared_data->mlfq->pop();
+    }
+
+    static size_t size(const SchedulerData *shared_data)
+    {
+        return shared_data->mlfq->size();
+    }
+
+    static void dispatched(SchedulerData *shared_data, CoreState& core, Process *p)
+    {
+        core.slice = mlfqTimeSlice(shared_data, p->getQueueLevel());
+    }
+
+    static bool shouldYield(SchedulerData *shared_data, const CoreState& core, const Process *p, uint32_t ran)
+    {
+        int waiting_level = shared_data->mlfq->topLevel();
+        return ran >= core.slice || (waiting_level >= 0 && waiting_level < p->getQueueLevel());
+    }
+
+    static void requeue(SchedulerData *shared_data, const CoreState& core, Process *p, uint32_t ran)
+    {
+        if (ran >= core.slice && p->getQueueLevel() + 1 < shared_data->mlfq->numLevels())
+        {
+            p->setQueueLevel(p->getQueueLevel() + 1);
+        }
+    }
+};
+
+// CFS: slice from the target latency, vruntime charged whenever the process stops
+struct CfsPolicy : BasePolicy {
+    static const bool preemptible = true;
+    static const bool locked_yield = true;
+
+    static void create(SchedulerData *shared_data, const SchedulerConfig *config)
+    {
+        shared_data->cfs = new CfsRunQueue(config->cfs_latency, config->cfs_min_granularity, config->cores);
+    }
+
+    static void push(SchedulerData *shared_data, Process *p)
+    {
+        shared_data->cfs->push(p);
+    }
+
+    static Process* pop(SchedulerData *shared_data, uint8_t core_id, const Process *previous)
+    {
+        return shared_data->cfs->pop();
+    }
+
+    static size_t size(const SchedulerData *shared_data)
+    {
+        return shared_data->cfs->size();
+    }
+
+    static void dispatched(SchedulerData *shared_data, CoreState& core, Process *p)
+    {
+        core.slice = shared_data->cfs->timeSlice(p);
+    }
+
+    static bool shouldYield(SchedulerData *shared_data, const CoreState& core, const Process *p, uint32_t ran)
+    {
+        return shared_data->cfs->shouldPreempt(p, ran, core.slice);
+    }
+
+    static void stopped(SchedulerData *shared_data, const CoreState& core, Process *p, uint32_t ran)
+    {
+        shared_data->cfs->charge(p, ran);
+    }
+};
+
+// PP, EDF, SRTF and PSRTF: a better waiting process takes the core
+// (shouldYield asks the policy's queue)
+struct PreemptivePolicy : BasePolicy {
+    static const bool preemptible = true;
+    static const bool locked_yield = true;
+};
+
+// PP: higher effective priority (after aging) first
+struct PriorityPolicy : PreemptivePolicy {
+    static void create(SchedulerData *shared_data, const SchedulerConfig *config)
+    {
+        shared_data->aging = new AgingQueue(5, config->pp_aging);
+    }
+
+    static void push(SchedulerData *shared_data, Process *p)
+    {
+        shared_data->aging->push(p, clockTime(shared_data));
+    }
+
+    static Process* pop(SchedulerData *shared_data, uint8_t core_id, const Process *previous)
+    {
+        return shared_data->aging->pop(clockTime(shared_data));
+    }
+
+    static size_t size(const SchedulerData *shared_data)
+    {
+        return shared_data->aging->size();
+    }
+
+    static bool shouldYield(SchedulerData *shared_data, const CoreState& core, const Process *p, uint32_t ran)
+    {
+        return shared_data->aging->bestPriority(clockTime(shared_data)) < p->getPriority();
+    }
+};
+
+// EDF: earliest absolute deadline first
+struct EdfPolicy : PreemptivePolicy {
+    static void create(SchedulerData *shared_data, const SchedulerConfig *config)
+    {
+        shared_data->edf = new EdfQueue();
+    }
+
+    static void push(SchedulerData *shared_data, Process *p)
+    {
+        shared_data->edf->push(p);
+    }
+
+    static Process* pop(SchedulerData *shared_data, uint8_t core_id, const Process *previous)
+    {
+        return shared_data->edf->pop();
+    }
+
+    static size_t size(const SchedulerData *shared_data)
+    {
+        return shared_data->edf->size();
+    }
+
+    static bool shouldYield(SchedulerData *shared_data, const CoreState& core, const Process *p, uint32_t ran)
+    {
+        const Process *next = shared_data->edf->front();
+        return next != NULL && next->getAbsoluteDeadline() < p->getAbsoluteDeadline();
+    }
+};
+
+// SRTF: shortest remaining time first. Running processes are tracked so that
+// an arrival can flag the core with the longest remaining time.
+struct SrtfPolicy : PreemptivePolicy {
+    static void create(SchedulerData *shared_data, const SchedulerConfig *config)
+    {
+        shared_data->srtf = new SrtfQueue();
+        shared_data->running = new RunningSet(config->cores);
+    }
+
+    static void push(SchedulerData *shared_data, Process *p)
+    {
+        shared_data->srtf->push(p);
+    }
+
+    static Process* pop(SchedulerData *shared_data, uint8_t core_id, const Process *previous)
+    {
+        return shared_data->srtf->pop();
+    }
+
+    static size_t size(const SchedulerData *shared_data)
+    {
+        return shared_data->srtf->size();
+    }
+
+    static void dispatched(SchedulerData *shared_data, CoreState& core, Process *p)
+    {
+        shared_data->running->add(core.core, expectedMs(shared_data, p), clockTime(shared_data));
+    }
+
+    static bool shouldYield(SchedulerData *shared_data, const CoreState& core, const Process *p, uint32_t ran)
+    {
+        return shared_data->running->preemptRequested(p->getCpuCore());
+    }
+
+    static void stopped(SchedulerData *shared_data, const CoreState& core, Process *p, uint32_t ran)
+    {
+        shared_data->running->remove(core.core);
+    }
+};
+
+// PSRTF: SRTF on the predicted rest of the current burst
+struct PsrtfPolicy : SrtfPolicy {
+    static void create(SchedulerData *shared_data, const SchedulerConfig *config)
+    {
+        shared_data->predicted = new PredictedQueue();
+        shared_data->running = new RunningSet(config->cores);
+    }
+
+    static void push(SchedulerData *shared_data, Process *p)
+    {
+        shared_data->predicted->push(p);
+    }
+
+    static Process* pop(SchedulerData *shared_data, uint8_t core_id, const Process *previous)
+    {
+        return shared_data->predicted->pop();
+    }
+
+    static size_t size(const SchedulerData *shared_data)
+    {
+        return shared_data->predicted->size();
+    }
+};
+
+// Calls `engine.template run<Policy>()` with the policy type of `algorithm`;
+// every engine maps algorithms to policies through here
+template <typename Engine>
+typename Engine::result_type withPolicy(ScheduleAlgorithm algorithm, Engine& engine)
+{
+    switch (algorithm)
+    {
+        case ScheduleAlgorithm::SJF:
+            return engine.template run<SjfPolicy>();
+        case ScheduleAlgorithm::PSJF:
+            return engine.template run<PsjfPolicy>();
+        case ScheduleAlgorithm::HRRN:
+            return engine.template run<HrrnPolicy>();
+        case ScheduleAlgorithm::RR:
+            return engine.template run<RoundRobinPolicy>();
+        case ScheduleAlgorithm::LOTTERY:
+            return engine.template run<LotteryPolicy>();
+        case ScheduleAlgorithm::STRIDE:
+            return engine.template run<StridePolicy>();
+        case ScheduleAlgorithm::MLFQ:
+            return engine.template run<MlfqPolicy>();
+        case ScheduleAlgorithm::CFS:
+            return engine.template run<CfsPolicy>();
+        case ScheduleAlgorithm::PP:
+            return engine.template run<PriorityPolicy>();
+        case ScheduleAlgorithm::EDF:
+            return engine.template run<EdfPolicy>();
+        case ScheduleAlgorithm::SRTF:
+            return engine.template run<SrtfPolicy>();
+        case ScheduleAlgorithm::PSRTF:
+            return engine.template run<PsrtfPolicy>();
+        default:
+            return engine.template run<RunToCompletionPolicy>();
+    }
+}
+
+// The process on `core` stopped running after `ran` ms, for any reason
+// (caller must hold shared_data->mutex)
+template <typename Policy>
+void stopCore(SchedulerData *shared_data, const CoreState& core, Process *p, uint32_t ran)
+{
+    Policy::stopped(shared_data, core, p, ran);
+    shared_data->switches++;
+    p->addCoreTime(ran, shared_data->topology->isLocal(p->getHomeNode(), core.core));
+}
+
+// Put the process on `core` back in the ready queue after it ran for `ran` ms
+// (caller must hold shared_data->mutex)
+template <typename Policy>
+void yieldCore(SchedulerData *shared_data, const CoreState& core, Process *p, uint32_t ran, uint32_t now)
+{
+    Policy::requeue(shared_data, core, p, ran);
+    stopCore<Policy>(shared_data, core, p, ran);
+    p->setState(Process::State::Ready, now);
+    p->updateBurstTime(p->getCurrentBurst(), p->workIn(ran));
+    p->setIntoQueueTime(now);
+    p->setCpuCore(-1);
+    Policy::push(shared_data, p);
+}
+
+// The process on `core` finished its last cpu burst (caller must hold shared_data->mutex)
+template <typename Policy>
+void terminateCore(SchedulerData *shared_data, const CoreState& core, Process *p, uint32_t ran, uint32_t now)
+{
+    burstFinished(shared_data, p);
+    stopCore<Policy>(shared_data, core, p, ran);
+    stopCompeting(shared_data, p, now);
+    p->setState(Process::State::Terminated, now);
+    p->setCpuCore(-1);
+    p->updateProcess(now);
+    shared_data->terminated.push_back(p);
+}
+
+// The process on `core` finished a cpu burst and starts i/o (caller must hold shared_data->mutex)
+template <typename Policy>
+void blockCore(SchedulerData *shared_data, const CoreState& core, Process *p, uint32_t ran, uint32_t now)
+{
+    burstFinished(shared_data, p);
+    stopCore<Policy>(shared_data, core, p, ran);
+    stopCompeting(shared_data, p, now);
+    p->setState(Process::State::IO, now);
+    p->updateCurrentBurst();
+    p->setBurstStartTime(now);
+    p->resetBurstTimeElapsed();
+    p->setCpuCore(-1);
+    ioSubmit(shared_data, p, now);
+}
+
+// Take the next process for `core` off the ready queue and start it there.
+// Returns NULL (core marked idle) when nothing suitable is waiting. A process
+// that last ran on another core first refills this core's caches: its work
+// starts *migration ms from now. (caller must hold shared_data->mutex)
+template <typename Policy>
+Process* dispatchCore(SchedulerData *shared_data, CoreState& core, const Process *previous, uint32_t now,
+                      uint32_t *migration)
+{
+    uint8_t core_id = core.core;
+    Process *p = NULL;
+    shared_data->idle[core_id] = true;
+    if (Policy::size(shared_data) > fasterIdleCores(shared_data, core_id)){
+        p = Policy::pop(shared_data, core_id, previous);
+    }
+    if (p == NULL){
+        return NULL;
+    }
+    shared_data->idle[core_id] = false;
+    *migration = 0;
+    if (p->getLastCore() >= 0 && p->getLastCore() != core_id){
+        *migration = shared_data->migration_penalty;
+        p->addMigration(*migration);
+    }
+    p->updateProcess(now);
+    p->setState(Process::State::Running, now);
+    p->setCpuCore(core_id);
+    if (p->isLaunched() != true){
+        p->setLaunched(true);
+        p->setLaunchTime(now);
+    }
+    p->resetBurstTimeElapsed();
+    p->setBurstStartTime(now + *migration);
+    p->setSliceStartTime(now + *migration);
+    p->setRunRate(shared_data->topology->rate(p->getHomeNode(), core_id));
+    Policy::dispatched(shared_data, core, p);
+    return p;
+}
+
+#endif // __SCHEDULER_H_
@@ -0,0 +1,52 @@
+#ifndef __SIMULATOR_H_
+#define __SIMULATOR_H_
+
+#include <string>
+#include <vector>
+#include "configreader.h"
+#include "process.h"
+#include "report.h"
+#include "options.h"
+
+// Outcome of one virtual-time run
+typedef struct SimulationResult {
+    RunSummary summary;
+    uint32_t start;         // virtual time the processes were created (per-process times are relative to it)
+    uint64_t events;        // arrivals, dispatches, cores released and i/o completions handled
+    double setup_seconds;   // wall time creating the scheduler state and processes
+    double run_seconds;     // wall time in the event loop and summary
+    std::string error;      // why the run could not start (a checkpoint that could not be restored)
+} SimulationResult;
+
+// What happened to a process at one event
+enum TraceKind : uint8_t { TraceArrival, TraceIoDone, TraceDispatch, TraceYield, TraceBlock, TraceTerminate };
+
+// One handled event, in the order the engine handled it
+typedef struct TraceEvent {
+    uint32_t time;          // ms since the processes were created
+    TraceKind kind;
+    uint16_t pid;
+    int16_t core;           // -1 for arrivals and i/o completions
+} TraceEvent;
+
+// Virtual-time engine: runs `config` to completion on the calling thread,
+// moving the clock straight from one scheduling event to the next. It uses
+// the ready queues, policies and state transitions of the real-time engine;
+// context switches and bursts take exactly their configured time, and the
+// result depends only on the configuration. `config` is only read, so
+// concurrent simulations may share it. `processes` receives the simulated
+// processes (the caller deletes them). With a `trace`, every event is
+// appended to it. With a `checkpoint` spec, the run can start from a saved
+// checkpoint and save its state every `every` simulated ms; a checkpoint
+// holds everything the rest of the run depends on, so a restored run ends
+// exactly as an uninterrupted one (its trace starts at the checkpoint).
+// Checkpoints are written by a forked child from its copy of the state, so
+// the event loop only pays for the fork; one that falls due while the
+// previous one is still being written is skipped. Since it forks, do not
+// checkpoint while the program runs other threads.
+SimulationResult simulate(const SchedulerConfig *config, std::vector<Process*>& processes,
+                          std::vector<TraceEvent> *trace = NULL, const CheckpointSpec *checkpoint = NULL);
+bool writeTrace(const std::string& filename, const std::vector<TraceEvent>& trace);
+std::string traceKindToString(TraceKind kind);
+
+#endif // __SIMULATOR_H_
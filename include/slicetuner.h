@@ -0,0 +1,64 @@
+#ifndef __SLICETUNER_H_
+#define __SLICETUNER_H_
+
+#include <vector>
+#include <cstdint>
+#include "configreader.h"
+#include "checkpoint.h"
+
+// One change of the RR time slice, with the observations that caused it
+typedef struct SliceAdjustment {
+    uint32_t time;            // ms since simulation start
+    uint32_t old_slice;
+    uint32_t new_slice;
+    double ready;             // mean ready queue length over the window
+    double overhead;          // fraction of busy core time spent context switching
+    uint32_t burst_p80;       // 80th percentile of recent cpu burst lengths (ms)
+} SliceAdjustment;
+
+// Online RR quantum controller. Every `interval` ms it looks at the last
+// window and moves the slice half way (geometrically) toward:
+//  - overhead: the slice that would make context switching `target_overhead`
+//    of busy core time (overhead scales roughly with 1 / slice); it does not
+//    grow past the point where 80% of recent bursts already fit in a slice
+//  - response: the slice that gives a ready process the cpu within
+//    `target_response` ms, ~ (ready / cores) * (slice + context_switch)
+// The result is clamped to [min_slice, max_slice] and every change is logged.
+class SliceTuner {
+private:
+    SliceMode mode;
+    double target_overhead;
+    uint32_t target_response;
+    uint32_t interval;
+    uint32_t min_slice;
+    uint32_t max_slice;
+    uint32_t context_switch;
+    uint8_t cores;
+
+    // current window
+    uint32_t window_start;
+    uint32_t last_tick;
+    uint64_t ready_area;      // ready queue length integrated over ms
+    uint64_t busy_area;       // busy cores integrated over ms
+    uint64_t switches_before; // switch count at the start of the window
+
+    std::vector<uint32_t> bursts;   // ring of recent cpu burst lengths
+    size_t next_burst;
+    std::vector<SliceAdjustment> log;
+
+    uint32_t burstPercentile(double q) const;
+
+public:
+    SliceTuner(const SchedulerConfig *config);
+
+    void observeBurst(uint32_t length);
+    // called every main-loop tick with the total context switches so far;
+    // returns the slice to use from now on
+    uint32_t tick(uint32_t now, size_t ready, uint32_t busy_cores, uint64_t switches, uint32_t slice);
+    uint32_t nextAdjustment() const;    // time the current window closes
+    const std::vector<SliceAdjustment>& adjustments() const;
+    void save(CheckpointWriter& out) const;
+    void load(CheckpointReader& in);
+};
+
+#endif // __SLICETUNER_H_
@@ -0,0 +1,30 @@
+#ifndef __SWEEP_H_
+#define __SWEEP_H_
+
+#include <string>
+#include <vector>
+#include "configreader.h"
+#include "options.h"
+#include "report.h"
+
+// One combination of a parameter sweep and its results
+typedef struct SweepPoint {
+    ScheduleAlgorithm algorithm;
+    uint8_t cores;
+    uint32_t time_slice;
+    uint32_t context_switch;
+    RunSummary summary;
+    uint64_t events;
+} SweepPoint;
+
+// Runs every combination in `spec` on the workload of `base` as independent
+// virtual-time simulations on a fixed pool of worker threads, all reading the
+// same parsed workload. Points are returned in combination order (algorithm,
+// cores, time slice, context switch) whatever order they finished in.
+std::vector<SweepPoint> runSweep(const SchedulerConfig *base, const SweepSpec& spec);
+void printSweep(const std::vector<SweepPoint>& points);
+// One row per point, every metric with its difference from points[baseline]
+void printComparison(const std::vector<SweepPoint>& points, size_t baseline);
+bool writeSweep(ReportFormat format, const std::string& filename, const std::vector<SweepPoint>& points);
+
+#endif // __SWEEP_H_
@@ -0,0 +1,57 @@
+#ifndef __TIMESERIES_H_
+#define __TIMESERIES_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// One sampling window of the throughput time series
+typedef struct TimeSample {
+    uint32_t window_start;    // ms since simulation start
+    uint32_t window_length;   // ms covered (the final window may be partial)
+    uint32_t completions;     // processes terminated during the window
+    double ready_depth;       // mean ready queue length
+    uint32_t max_ready_depth; // largest ready queue length observed
+    double io_depth;          // mean number of processes doing i/o
+    double busy_cores;        // mean number of cores running a process
+} TimeSample;
+
+// Fixed-capacity ring buffer of sampling windows: once full, the oldest
+// windows are overwritten so memory stays bounded on long runs
+class TimeSeries {
+private:
+    uint32_t interval;
+    std::vector<TimeSample> samples;
+    size_t head;              // index of the oldest window
+    size_t count;             // number of windows stored
+    uint64_t dropped;         // windows overwritten after the buffer filled
+
+    // accumulators for the window currently being observed
+    uint32_t window_start;
+    uint32_t completed_before;
+    uint32_t last_completed;
+    uint32_t ticks;
+    uint64_t ready_sum;
+    uint64_t io_sum;
+    uint64_t busy_sum;
+    uint32_t ready_max;
+    uint32_t last_ready;
+    uint32_t last_io;
+    uint32_t last_busy;
+
+    void closeWindow(uint32_t end_time);
+
+public:
+    TimeSeries(uint32_t interval, uint32_t capacity);
+
+    // `now` is ms since simulation start, `completed` the running total of terminated processes
+    void observe(uint32_t now, uint32_t ready, uint32_t io, uint32_t busy, uint32_t completed);
+    void finish(uint32_t now);
+
+    size_t size() const;
+    uint64_t droppedWindows() const;
+    const TimeSample& at(size_t i) const;   // 0 = oldest window kept
+    bool writeCsv(const std::string& filename, uint8_t cores) const;
+};
+
+#endif // __TIMESERIES_H_
@@ -0,0 +1,33 @@
+#ifndef __TOPOLOGY_H_
+#define __TOPOLOGY_H_
+
+#include <vector>
+#include <cstdint>
+#include "configreader.h"
+
+// Layout of the simulated machine: cores grouped into NUMA nodes, with a
+// distance between every pair of nodes (SLIT style: 10 = local), and a speed
+// per core for mixed hardware (2.0 = finishes a burst in half the time)
+class Topology {
+private:
+    uint8_t nodes;
+    uint8_t cores_per_node;
+    std::vector<uint32_t> distance;   // nodes x nodes, row-major
+    std::vector<double> rates;        // progress rate for each (home, node) pair
+    std::vector<double> speeds;       // per core
+    double stretch;
+
+public:
+    Topology(const SchedulerConfig *config);
+
+    uint8_t numNodes() const;
+    uint8_t nodeOf(uint8_t core) const;
+    bool isLocal(uint8_t home, uint8_t core) const;
+    double speed(uint8_t core) const;
+    bool isHeterogeneous() const;
+    // ms of work done per ms on `core` by a process whose memory is on `home`:
+    // the core's speed, divided by 1 + stretch * (d_remote / d_local - 1) when remote
+    double rate(uint8_t home, uint8_t core) const;
+};
+
+#endif // __TOPOLOGY_H_
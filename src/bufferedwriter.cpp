@@ -0,0 +1,168 @@
+#include <cmath>
+#include <cstring>
+#include "bufferedwriter.h"
+
+BufferedWriter::BufferedWriter(FILE *file) : file(file), owns_file(false), length(0), failed(false)
+{
+    buffer = new char[CAPACITY];
+}
+
+BufferedWriter::BufferedWriter(const std::string& filename) : owns_file(true), length(0), failed(false)
+{
+    if (filename == "-")
+    {
+        file = stdout;
+        owns_file = false;
+    }
+    else
+    {
+        file = fopen(filename.c_str(), "w");
+    }
+    buffer = new char[CAPACITY];
+}
+
+BufferedWriter::~BufferedWriter()
+{
+    flush();
+    if (owns_file && file != NULL)
+    {
+        fclose(file);
+    }
+    delete[] buffer;
+}
+
+bool BufferedWriter::isOpen() const
+{
+    return file != NULL;
+}
+
+bool BufferedWriter::flush()
+{
+    if (file == NULL)
+    {
+        return false;
+    }
+    if (length > 0 && fwrite(buffer, 1, length, file) != length)
+    {
+        failed = true;
+    }
+    length = 0;
+    if (fflush(file) != 0)
+    {
+        failed = true;
+    }
+    return !failed;
+}
+
+// Make room for `n` more bytes (n is always much smaller than CAPACITY)
+void BufferedWriter::reserve(size_t n)
+{
+    if (length + n > CAPACITY)
+    {
+        if (file != NULL && fwrite(buffer, 1, length, file) != length)
+        {
+            failed = true;
+        }
+        length = 0;
+    }
+}
+
+BufferedWriter& BufferedWriter::put(char c)
+{
+    reserve(1);
+    buffer[length++] = c;
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::put(const char *str)
+{
+    size_t n = strlen(str);
+    while (n > 0)
+    {
+        size_t chunk = (n < CAPACITY) ? n : CAPACITY;
+        reserve(chunk);
+        memcpy(buffer + length, str, chunk);
+        length += chunk;
+        str += chunk;
+        n -= chunk;
+    }
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::put(const std::string& str)
+{
+    return put(str.c_str());
+}
+
+BufferedWriter& BufferedWriter::putUnsigned(uint64_t value)
+{
+    char digits[20];
+    int n = 0;
+    do
+    {
+        digits[n++] = '0' + (value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    reserve(n);
+    while (n > 0)
+    {
+        buffer[length++] = digits[--n];
+    }
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::putSigned(int64_t value)
+{
+    if (value < 0)
+    {
+        put('-');
+        return putUnsigned((uint64_t)0 - (uint64_t)value);
+    }
+    return putUnsigned(value);
+}
+
+BufferedWriter& BufferedWriter::putDouble(double value, int precision)
+{
+    reserve(64);
+    int n = snprintf(buffer + length, 64, "%.*f", precision, value);
+    if (n > 0)
+    {
+        length += (n < 64) ? n : 63;
+    }
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::putMetric(double value, bool json)
+{
+    if (std::isfinite(value)) putDouble(value, 6);
+    else if (json) put("null");
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::putJsonString(const std::string& str)
+{
+    size_t i;
+    put('"');
+    for (i = 0; i < str.size(); i++)
+    {
+        char c = str[i];
+        if (c == '"' || c == '\\')
+        {
+            put('\\');
+            put(c);
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)c);
+            put(escaped);
+        }
+        else
+        {
+            put(c);
+        }
+    }
+    put('"');
+    return *this;
+}
@@ -0,0 +1,295 @@
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "checkpoint.h"
+
+static const char CHECKPOINT_MAGIC[8] = {'O', 'S', 'S', 'C', 'K', 'P', 'T', '\0'};
+static const uint32_t CHECKPOINT_VERSION = 3;
+static const uint32_t NO_PROCESS = UINT32_MAX;
+
+static uint64_t fnv1a(const void *bytes, size_t length, uint64_t hash = 14695981039346656037ULL)
+{
+    const unsigned char *p = (const unsigned char*)bytes;
+    size_t i;
+    for (i = 0; i < length; i++)
+    {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+CheckpointWriter::CheckpointWriter(const std::vector<Process*>& processes)
+{
+    uint32_t i;
+    for (i = 0; i < processes.size(); i++)
+    {
+        index[processes[i]] = i;
+    }
+}
+
+void CheckpointWriter::putBytes(const void *bytes, size_t length)
+{
+    data.append((const char*)bytes, length);
+}
+
+void CheckpointWriter::putU8(uint8_t value)
+{
+    putBytes(&value, sizeof(value));
+}
+
+void CheckpointWriter::putU16(uint16_t value)
+{
+    putBytes(&value, sizeof(value));
+}
+
+void CheckpointWriter::putU32(uint32_t value)
+{
+    putBytes(&value, sizeof(value));
+}
+
+void CheckpointWriter::putU64(uint64_t value)
+{
+    putBytes(&value, sizeof(value));
+}
+
+void CheckpointWriter::putDouble(double value)
+{
+    putBytes(&value, sizeof(value));
+}
+
+void CheckpointWriter::putBool(bool value)
+{
+    putU8(value ? 1 : 0);
+}
+
+void CheckpointWriter::putString(const std::string& value)
+{
+    putU32(value.size());
+    putBytes(value.data(), value.size());
+}
+
+void CheckpointWriter::putProcess(const Process *p)
+{
+    std::map<const Process*, uint32_t>::const_iterator it = index.find(p);
+    putU32((it == index.end()) ? NO_PROCESS : it->second);
+}
+
+const std::string& CheckpointWriter::image() const
+{
+    return data;
+}
+
+CheckpointReader::CheckpointReader(const std::string& image, const std::vector<Process*>& processes)
+    : data(image), offset(0), failed(false), processes(&processes)
+{
+}
+
+bool CheckpointReader::getBytes(void *bytes, size_t length)
+{
+    if (failed || data.size() - offset < length)
+    {
+        failed = true;
+        memset(bytes, 0, length);
+        return false;
+    }
+    memcpy(bytes, data.data() + offset, length);
+    offset += length;
+    return true;
+}
+
+uint8_t CheckpointReader::getU8()
+{
+    uint8_t value;
+    getBytes(&value, sizeof(value));
+    return value;
+}
+
+uint16_t CheckpointReader::getU16()
+{
+    uint16_t value;
+    getBytes(&value, sizeof(value));
+    return value;
+}
+
+uint32_t CheckpointReader::getU32()
+{
+    uint32_t value;
+    getBytes(&value, sizeof(value));
+    return value;
+}
+
+uint64_t CheckpointReader::getU64()
+{
+    uint64_t value;
+    getBytes(&value, sizeof(value));
+    return value;
+}
+
+double CheckpointReader::getDouble()
+{
+    double value;
+    getBytes(&value, sizeof(value));
+    return value;
+}
+
+bool CheckpointReader::getBool()
+{
+    return getU8() != 0;
+}
+
+std::string CheckpointReader::getString()
+{
+    uint32_t length = getU32();
+    if (failed || data.size() - offset < length)
+    {
+        failed = true;
+        return "";
+    }
+    std::string value = data.substr(offset, length);
+    offset += length;
+    return value;
+}
+
+Process* CheckpointReader::getProcess()
+{
+    uint32_t i = getU32();
+    if (failed || i == NO_PROCESS)
+    {
+        return NULL;
+    }
+    if (i >= processes->size())
+    {
+        failed = true;
+        return NULL;
+    }
+    return (*processes)[i];
+}
+
+void CheckpointReader::fail()
+{
+    failed = true;
+}
+
+bool CheckpointReader::ok() const
+{
+    return !failed;
+}
+
+bool CheckpointReader::atEnd() const
+{
+    return offset == data.size();
+}
+
+uint64_t configFingerprint(const SchedulerConfig *config)
+{
+    uint64_t hash = fnv1a(&config->cores, sizeof(config->cores));
+    hash = fnv1a(&config->algorithm, sizeof(config->algorithm), hash);
+    hash = fnv1a(&config->context_switch, sizeof(config->context_switch), hash);
+    hash = fnv1a(&config->time_slice, sizeof(config->time_slice), hash);
+    hash = fnv1a(&config->num_processes, sizeof(config->num_processes), hash);
+    int i;
+    for (i = 0; i < config->num_processes; i++)
+    {
+        const ProcessDetails& details = config->processes[i];
+        hash = fnv1a(&details.pid, sizeof(details.pid), hash);
+        hash = fnv1a(&details.start_time, sizeof(details.start_time), hash);
+        hash = fnv1a(&details.num_bursts, sizeof(details.num_bursts), hash);
+        hash = fnv1a(details.burst_times, details.num_bursts * sizeof(uint32_t), hash);
+        hash = fnv1a(&details.priority, sizeof(details.priority), hash);
+        hash = fnv1a(&details.deadline, sizeof(details.deadline), hash);
+        hash = fnv1a(&details.shares, sizeof(details.shares), hash);
+        hash = fnv1a(&details.home_node, sizeof(details.home_node), hash);
+    }
+    size_t l;
+    for (l = 0; l < config->option_lines.size(); l++)
+    {
+        hash = fnv1a(config->option_lines[l].data(), config->option_lines[l].size() + 1, hash);
+    }
+    return hash;
+}
+
+static bool writeAll(int fd, const void *bytes, size_t length)
+{
+    const char *p = (const char*)bytes;
+    while (length > 0)
+    {
+        ssize_t n = write(fd, p, length);
+        if (n < 0)
+        {
+            return false;
+        }
+        p += n;
+        length -= n;
+    }
+    return true;
+}
+
+bool writeCheckpointFile(const std::string& filename, uint64_t fingerprint, const std::string& image)
+{
+    std::string temporary = filename + ".tmp";
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    uint64_t length = image.size();
+    uint64_t checksum = fnv1a(image.data(), image.size());
+    bool written = writeAll(fd, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) &&
+                   writeAll(fd, &CHECKPOINT_VERSION, sizeof(CHECKPOINT_VERSION)) &&
+                   writeAll(fd, &fingerprint, sizeof(fingerprint)) &&
+                   writeAll(fd, &length, sizeof(length)) &&
+                   writeAll(fd, image.data(), image.size()) &&
+                   writeAll(fd, &checksum, sizeof(checksum)) &&
+                   fsync(fd) == 0;
+    written = (close(fd) == 0) && written;
+    if (!written || rename(temporary.c_str(), filename.c_str()) != 0)
+    {
+        unlink(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool readCheckpointFile(const std::string& filename, uint64_t fingerprint, std::string *image, std::string *error)
+{
+    std::ifstream in(filename.c_str(), std::ios::binary | std::ios::ate);
+    if (!in)
+    {
+        *error = "could not open " + filename;
+        return false;
+    }
+    uint64_t file_size = in.tellg();
+    in.seekg(0);
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    uint32_t version;
+    uint64_t file_fingerprint, length, checksum;
+    in.read(magic, sizeof(magic));
+    in.read((char*)&version, sizeof(version));
+    if (!in || memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 || version != CHECKPOINT_VERSION)
+    {
+        *error = filename + " is not a checkpoint of this version";
+        return false;
+    }
+    in.read((char*)&file_fingerprint, sizeof(file_fingerprint));
+    in.read((char*)&length, sizeof(length));
+    if (!in || file_fingerprint != fingerprint)
+    {
+        *error = filename + " was taken from a different configuration";
+        return false;
+    }
+    if (length > file_size)
+    {
+        *error = filename + " is damaged";
+        return false;
+    }
+    image->resize(length);
+    in.read(&(*image)[0], length);
+    in.read((char*)&checksum, sizeof(checksum));
+    if (!in || checksum != fnv1a(image->data(), image->size()))
+    {
+        *error = filename + " is damaged";
+        return false;
+    }
+    return true;
+}
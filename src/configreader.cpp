@@ -1,10 +1,18 @@
+#include <cmath>
+#include <random>
 #include "configreader.h"
 
+static bool readOption(SchedulerConfig *config, const std::string& line, bool warn);
+static void setOptionDefaults(SchedulerConfig *config);
+static void resolveOptions(SchedulerConfig *config, bool warn);
+static void placeHomeNodes(SchedulerConfig *config, const std::vector<int>& home_nodes);
+
 SchedulerConfig* readConfigFile(const char *filename)
 {
     std::string line;
     std::ifstream file(filename);
     SchedulerConfig *config = new SchedulerConfig();
+    config->owns_processes = true;
     
     // read line 1 --> number of cpu cores
     std::getline(file, line);
@@ -12,10 +20,10 @@ SchedulerConfig* readConfigFile(const char *filename)
 
     // read line 2 --> scheduling algorithm
     std::getline(file, line);
-    if      (line == "FCFS") config->algorithm = ScheduleAlgorithm::FCFS;
-    else if (line == "SJF")  config->algorithm = ScheduleAlgorithm::SJF;
-    else if (line == "RR")   config->algorithm = ScheduleAlgorithm::RR;
-    else if (line == "PP")   config->algorithm = ScheduleAlgorithm::PP;
+    if (!parseAlgorithm(line, &config->algorithm))
+    {
+        std::cerr << "Warning: unknown scheduling algorithm '" << line << "'" << std::endl;
+    }
 
     // read line 3 --> context switch time (ms)
     std::getline(file, line);
@@ -24,6 +32,12 @@ SchedulerConfig* readConfigFile(const char *filename)
     // read line 4 --> time slice (ms)
     std::getline(file, line);
     config->time_slice = std::stoi(line);
+    if (config->time_slice == 0)
+    {
+        // a 0 ms slice hands the core back before any work is done
+        std::cerr << "Warning: time slice must be at least 1 ms, using 1" << std::endl;
+        config->time_slice = 1;
+    }
 
     // read line 5 --> number of processes
     std::getline(file, line);
@@ -32,6 +46,7 @@ SchedulerConfig* readConfigFile(const char *filename)
 
     // read lines 6 - N --> details for each process
     int i, j;
+    std::vector<int> home_nodes(config->num_processes);
     std::string item1, item2;
     std::stringstream ss1, ss2;
     for (i = 0; i < config->num_processes; i++)
@@ -60,29 +75,502 @@ SchedulerConfig* readConfigFile(const char *filename)
             config->processes[i].burst_times[j] = std::stoi(item2);
         }
 
-        // column 4 --> priority
+        // column 4 --> priority (kept for every algorithm; ignored by the ones
+        // that do not use it when the process is created)
         std::getline(ss1, item1, ',');
-        if (config->algorithm == ScheduleAlgorithm::PP)
+        config->processes[i].priority = std::stoi(item1);
+
+        // column 5 (optional) --> relative deadline
+        config->processes[i].deadline = 0;
+        if (std::getline(ss1, item1, ',') && !item1.empty() && item1 != "\r")
+        {
+            config->processes[i].deadline = std::stoi(item1);
+        }
+
+        // column 6 (optional) --> proportional-share tickets
+        config->processes[i].shares = 0;
+        if (std::getline(ss1, item1, ',') && !item1.empty() && item1 != "\r")
+        {
+            config->processes[i].shares = std::stoi(item1);
+        }
+
+        // column 7 (optional) --> NUMA home node (resolved once the topology is known)
+        home_nodes[i] = -1;
+        if (std::getline(ss1, item1, ',') && !item1.empty() && item1 != "\r")
         {
-            config->processes[i].priority = std::stoi(item1);
+            home_nodes[i] = std::stoi(item1);
         }
-        else
+    }
+
+    // remaining lines --> optional algorithm parameters ("name=value")
+    setOptionDefaults(config);
+    while (std::getline(file, line))
+    {
+        if (readOption(config, line, true))
         {
-            config->processes[i].priority = 0;
+            config->option_lines.push_back(line);
         }
     }
+    resolveOptions(config, true);
+    placeHomeNodes(config, home_nodes);
 
     return config;
 }
 
-void deleteConfig(SchedulerConfig *config)
+// A copy of `base` run with a different algorithm, core count, time slice or
+// context switch. The options are re-read so defaults that depend on these
+// (cfs_latency, numa_steal, ...) follow them. The process list is shared with
+// `base`, which must outlive the copy.
+SchedulerConfig* deriveConfig(const SchedulerConfig *base, ScheduleAlgorithm algorithm, uint8_t cores,
+                              uint32_t time_slice, uint32_t context_switch)
+{
+    SchedulerConfig *config = new SchedulerConfig();
+    config->owns_processes = false;
+    config->cores = cores;
+    config->algorithm = algorithm;
+    config->context_switch = context_switch;
+    config->time_slice = time_slice;
+    config->num_processes = base->num_processes;
+    config->processes = base->processes;
+    config->option_lines = base->option_lines;
+    setOptionDefaults(config);
+    size_t i;
+    for (i = 0; i < config->option_lines.size(); i++)
+    {
+        readOption(config, config->option_lines[i], false);
+    }
+    resolveOptions(config, false);
+    return config;
+}
+
+// Gives `config` its own copy of the process list with every start time and
+// burst scaled by an independent draw from [1 - jitter, 1 + jitter] (bursts
+// stay at least 1 ms). The same seed always yields the same workload.
+void jitterWorkload(SchedulerConfig *config, double jitter, uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    std::uniform_real_distribution<double> factor(1.0 - jitter, 1.0 + jitter);
+    ProcessDetails *processes = new ProcessDetails[config->num_processes];
+    int i, j;
+    for (i = 0; i < config->num_processes; i++)
+    {
+        processes[i] = config->processes[i];
+        processes[i].start_time = (uint32_t)std::llround(config->processes[i].start_time * factor(random));
+        processes[i].burst_times = new uint32_t[processes[i].num_bursts];
+        for (j = 0; j < processes[i].num_bursts; j++)
+        {
+            double burst = config->processes[i].burst_times[j] * factor(random);
+            processes[i].burst_times[j] = std::max<uint32_t>(1, (uint32_t)std::llround(burst));
+        }
+    }
+    if (config->owns_processes)
+    {
+        for (i = 0; i < config->num_processes; i++)
+        {
+            delete[] config->processes[i].burst_times;
+        }
+        delete[] config->processes;
+    }
+    config->processes = processes;
+    config->owns_processes = true;
+}
+
+static void setOptionDefaults(SchedulerConfig *config)
+{
+    config->mlfq_levels = 3;
+    config->mlfq_slice_factor = 2;
+    config->mlfq_boost = 0;
+    config->mlfq_io_boost = false;
+    config->cfs_latency = 0;
+    config->cfs_min_granularity = 0;
+    config->lottery_seed = 1;
+    config->predict_alpha = 0.5;
+    config->predict_initial = 1000;
+    config->hrrn_epoch = 50;
+    config->pp_aging = 0;
+    config->migration_penalty = 0;
+    config->affinity = 0;
+    config->numa_nodes = 1;
+    config->numa_cores_per_node = 0;
+    config->numa_stretch = 0.5;
+    config->numa_policy = NumaPolicy::NumaIgnore;
+    config->numa_steal = 0;
+    config->hetero_policy = HeteroPolicy::HeteroIgnore;
+    config->io_deadline = 500;
+    config->io_seek = 0;
+    config->rr_adaptive = SliceMode::SliceStatic;
+    config->rr_target_overhead = 0.05;
+    config->rr_target_response = 100;
+    config->rr_adapt_interval = 250;
+    config->rr_min_slice = 0;
+    config->rr_max_slice = 0;
+}
+
+// Fill in the defaults that depend on other options
+static void resolveOptions(SchedulerConfig *config, bool warn)
+{
+    if (config->cfs_latency == 0) config->cfs_latency = 4 * config->time_slice;
+    if (config->cfs_min_granularity == 0) config->cfs_min_granularity = std::max(1u, config->time_slice / 2);
+    if (config->rr_min_slice == 0) config->rr_min_slice = std::max(1u, config->context_switch);
+    if (config->rr_max_slice == 0) config->rr_max_slice = 10 * config->time_slice;
+    config->rr_max_slice = std::max(config->rr_max_slice, config->rr_min_slice);
+
+    // NUMA
+    uint32_t nodes = config->numa_nodes;
+    if (config->numa_cores_per_node == 0)
+    {
+        config->numa_cores_per_node = std::max(1, (config->cores + config->numa_nodes - 1) / config->numa_nodes);
+    }
+    if (config->numa_distance.size() != nodes * nodes)
+    {
+        if (!config->numa_distance.empty() && warn)
+        {
+            std::cerr << "Warning: numa_distance needs " << nodes * nodes << " entries, using defaults" << std::endl;
+        }
+        config->numa_distance.assign(nodes * nodes, 20);
+        for (uint32_t n = 0; n < nodes; n++)
+        {
+            config->numa_distance[n * nodes + n] = 10;
+        }
+    }
+    if (config->numa_steal == 0) config->numa_steal = config->time_slice;
+    config->core_speeds.resize(config->cores, 1.0);
+}
+
+// Place every process on a home node (column 7, default pid % numa_nodes)
+static void placeHomeNodes(SchedulerConfig *config, const std::vector<int>& home_nodes)
 {
+    uint32_t nodes = config->numa_nodes;
     int i;
     for (i = 0; i < config->num_processes; i++)
     {
-        delete[] config->processes[i].burst_times;
+        int home = home_nodes[i];
+        config->processes[i].home_node = (home >= 0 && home < (int)nodes) ? home : config->processes[i].pid % nodes;
+    }
+}
+
+// Applies one "name=value" line; false if the line is blank, a comment or not an option
+static bool readOption(SchedulerConfig *config, const std::string& line, bool warn)
+{
+    if (line.empty() || line[0] == '#' || line == "\r")
+    {
+        return false;
+    }
+    size_t eq = line.find('=');
+    if (eq == std::string::npos)
+    {
+        if (warn) std::cerr << "Warning: ignoring config line '" << line << "'" << std::endl;
+        return false;
+    }
+    std::string name = line.substr(0, eq);
+    std::string value = line.substr(eq + 1);
+
+    if (name == "mlfq_levels")
+    {
+        config->mlfq_levels = std::max(1, std::min(32, std::stoi(value)));
+    }
+    else if (name == "mlfq_slice_factor")
+    {
+        config->mlfq_slice_factor = std::max(1, std::stoi(value));
+    }
+    else if (name == "mlfq_boost")
+    {
+        config->mlfq_boost = std::stoi(value);
+    }
+    else if (name == "mlfq_io_boost")
+    {
+        config->mlfq_io_boost = (std::stoi(value) != 0);
+    }
+    else if (name == "cfs_latency")
+    {
+        config->cfs_latency = std::stoi(value);
+    }
+    else if (name == "cfs_min_granularity")
+    {
+        config->cfs_min_granularity = std::stoi(value);
+    }
+    else if (name == "lottery_seed")
+    {
+        config->lottery_seed = std::stoull(value);
+    }
+    else if (name == "predict_alpha")
+    {
+        config->predict_alpha = std::max(0.0, std::min(1.0, std::stod(value)));
+    }
+    else if (name == "predict_initial")
+    {
+        config->predict_initial = std::stoi(value);
+    }
+    else if (name == "hrrn_epoch")
+    {
+        config->hrrn_epoch = std::max(1, std::stoi(value));
+    }
+    else if (name == "pp_aging")
+    {
+        config->pp_aging = std::stoi(value);
+    }
+    else if (name == "migration_penalty")
+    {
+        config->migration_penalty = std::stoi(value);
+    }
+    else if (name == "affinity")
+    {
+        config->affinity = std::stoi(value);
+    }
+    else if (name == "numa_nodes")
+    {
+        config->numa_nodes = std::max(1, std::min(64, std::stoi(value)));
+    }
+    else if (name == "numa_cores_per_node")
+    {
+        config->numa_cores_per_node = std::max(1, std::stoi(value));
+    }
+    else if (name == "numa_distance")
+    {
+        // rows separated by ';', entries by ','
+        std::string entry;
+        std::stringstream ss(value);
+        config->numa_distance.clear();
+        while (std::getline(ss, entry, ';'))
+        {
+            std::string item;
+            std::stringstream row(entry);
+            while (std::getline(row, item, ','))
+            {
+                config->numa_distance.push_back(std::max(1, std::stoi(item)));
+            }
+        }
+    }
+    else if (name == "numa_stretch")
+    {
+        config->numa_stretch = std::max(0.0, std::stod(value));
+    }
+    else if (name == "numa_policy")
+    {
+        if      (value == "none")    config->numa_policy = NumaPolicy::NumaIgnore;
+        else if (value == "local")   config->numa_policy = NumaPolicy::NumaLocal;
+        else if (value == "balance") config->numa_policy = NumaPolicy::NumaBalance;
+        else if (warn) std::cerr << "Warning: unknown numa_policy '" << value << "'" << std::endl;
+    }
+    else if (name == "numa_steal")
+    {
+        config->numa_steal = std::stoi(value);
+    }
+    else if (name == "core_speeds")
+    {
+        std::string item;
+        std::stringstream ss(value);
+        config->core_speeds.clear();
+        while (std::getline(ss, item, ','))
+        {
+            double speed = std::stod(item);
+            config->core_speeds.push_back((speed > 0) ? speed : 1.0);
+        }
+    }
+    else if (name == "io_devices")
+    {
+        // e.g. "fifo,sstf": a process does its i/o on device pid % count
+        std::string item;
+        std::stringstream ss(value);
+        config->io_devices.clear();
+        while (std::getline(ss, item, ','))
+        {
+            if      (item == "fifo")     config->io_devices.push_back(IoDiscipline::IoFifo);
+            else if (item == "sstf")     config->io_devices.push_back(IoDiscipline::IoSstf);
+            else if (item == "deadline") config->io_devices.push_back(IoDiscipline::IoDeadline);
+            else if (warn) std::cerr << "Warning: unknown i/o discipline '" << item << "'" << std::endl;
+        }
+    }
+    else if (name == "io_deadline")
+    {
+        config->io_deadline = std::stoi(value);
+    }
+    else if (name == "io_seek")
+    {
+        config->io_seek = std::stoi(value);
+    }
+    else if (name == "hetero_policy")
+    {
+        if      (value == "none")    config->hetero_policy = HeteroPolicy::HeteroIgnore;
+        else if (value == "fastest") config->hetero_policy = HeteroPolicy::HeteroFastest;
+        else if (warn) std::cerr << "Warning: unknown hetero_policy '" << value << "'" << std::endl;
+    }
+    else if (name == "rr_adaptive")
+    {
+        if      (value == "none")     config->rr_adaptive = SliceMode::SliceStatic;
+        else if (value == "overhead") config->rr_adaptive = SliceMode::SliceOverhead;
+        else if (value == "response") config->rr_adaptive = SliceMode::SliceResponse;
+        else if (warn) std::cerr << "Warning: unknown rr_adaptive mode '" << value << "'" << std::endl;
+    }
+    else if (name == "rr_target_overhead")
+    {
+        double target = std::stod(value);
+        config->rr_target_overhead = (target > 0 && target < 1) ? target : 0.05;
+    }
+    else if (name == "rr_target_response")
+    {
+        config->rr_target_response = std::max(1, std::stoi(value));
+    }
+    else if (name == "rr_adapt_interval")
+    {
+        config->rr_adapt_interval = std::max(1, std::stoi(value));
+    }
+    else if (name == "rr_min_slice")
+    {
+        config->rr_min_slice = std::stoi(value);
+    }
+    else if (name == "rr_max_slice")
+    {
+        config->rr_max_slice = std::stoi(value);
+    }
+    else
+    {
+        if (warn) std::cerr << "Warning: unknown config option '" << name << "'" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void deleteConfig(SchedulerConfig *config)
+{
+    int i;
+    if (config->owns_processes)
+    {
+        for (i = 0; i < config->num_processes; i++)
+        {
+            delete[] config->processes[i].burst_times;
+        }
+        delete[] config->processes;
     }
-    delete[] config->processes;
     delete config;
     config = NULL;
 }
+
+std::string algorithmToString(ScheduleAlgorithm algorithm)
+{
+    std::string str;
+    switch (algorithm)
+    {
+        case ScheduleAlgorithm::FCFS:
+            str = "FCFS";
+            break;
+        case ScheduleAlgorithm::SJF:
+            str = "SJF";
+            break;
+        case ScheduleAlgorithm::RR:
+            str = "RR";
+            break;
+        case ScheduleAlgorithm::PP:
+            str = "PP";
+            break;
+        case ScheduleAlgorithm::MLFQ:
+            str = "MLFQ";
+            break;
+        case ScheduleAlgorithm::CFS:
+            str = "CFS";
+            break;
+        case ScheduleAlgorithm::EDF:
+            str = "EDF";
+            break;
+        case ScheduleAlgorithm::STRIDE:
+            str = "STRIDE";
+            break;
+        case ScheduleAlgorithm::LOTTERY:
+            str = "LOTTERY";
+            break;
+        case ScheduleAlgorithm::SRTF:
+            str = "SRTF";
+            break;
+        case ScheduleAlgorithm::PSJF:
+            str = "PSJF";
+            break;
+        case ScheduleAlgorithm::PSRTF:
+            str = "PSRTF";
+            break;
+        case ScheduleAlgorithm::HRRN:
+            str = "HRRN";
+            break;
+        default:
+            str = "unknown";
+            break;
+    }
+    return str;
+}
+
+// Algorithm named `name` (as on line 2 of a config file); false if there is none
+bool parseAlgorithm(const std::string& name, ScheduleAlgorithm *algorithm)
+{
+    int i;
+    for (i = 0; i < NUM_ALGORITHMS; i++)
+    {
+        if (name == algorithmToString((ScheduleAlgorithm)i))
+        {
+            *algorithm = (ScheduleAlgorithm)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Algorithms that read the priority column (all others run every process at priority 0)
+bool usesPriority(ScheduleAlgorithm algorithm)
+{
+    return algorithm == ScheduleAlgorithm::PP || algorithm == ScheduleAlgorithm::CFS ||
+           isProportionalShare(algorithm);
+}
+
+// Algorithms that hand out cpu time in proportion to tickets
+bool isProportionalShare(ScheduleAlgorithm algorithm)
+{
+    return algorithm == ScheduleAlgorithm::STRIDE || algorithm == ScheduleAlgorithm::LOTTERY;
+}
+
+// Algorithms that order by a predicted (rather than the known) next cpu burst
+bool isPredictive(ScheduleAlgorithm algorithm)
+{
+    return algorithm == ScheduleAlgorithm::PSJF || algorithm == ScheduleAlgorithm::PSRTF;
+}
+
+std::string numaPolicyToString(NumaPolicy policy)
+{
+    switch (policy)
+    {
+        case NumaPolicy::NumaLocal:
+            return "local";
+        case NumaPolicy::NumaBalance:
+            return "balance";
+        default:
+            return "none";
+    }
+}
+
+std::string heteroPolicyToString(HeteroPolicy policy)
+{
+    return (policy == HeteroPolicy::HeteroFastest) ? "fastest" : "none";
+}
+
+std::string ioDisciplineToString(IoDiscipline discipline)
+{
+    switch (discipline)
+    {
+        case IoDiscipline::IoSstf:
+            return "sstf";
+        case IoDiscipline::IoDeadline:
+            return "deadline";
+        default:
+            return "fifo";
+    }
+}
+
+std::string sliceModeToString(SliceMode mode)
+{
+    switch (mode)
+    {
+        case SliceMode::SliceOverhead:
+            return "overhead";
+        case SliceMode::SliceResponse:
+            return "response";
+        default:
+            return "none";
+    }
+}
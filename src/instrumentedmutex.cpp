@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "instrumentedmutex.h"
+
+static int bucketOf(uint64_t ns)
+{
+    int bucket = 0;
+    while (ns > 1 && bucket < LOCK_HISTOGRAM_BUCKETS - 1)
+    {
+        ns >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static uint64_t elapsedNs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+}
+
+InstrumentedMutex::InstrumentedMutex() : recording(false), holder(LockSite::LockOther)
+{
+    memset(sites, 0, sizeof(sites));
+}
+
+void InstrumentedMutex::enableStats(bool enable)
+{
+    recording = enable;
+}
+
+bool InstrumentedMutex::statsEnabled() const
+{
+    return recording;
+}
+
+void InstrumentedMutex::lock(LockSite site)
+{
+    if (!recording)
+    {
+        mutex.lock();
+        return;
+    }
+    LockSiteStats& stats = sites[site];
+    if (mutex.try_lock())
+    {
+        acquired = std::chrono::steady_clock::now();
+    }
+    else
+    {
+        std::chrono::steady_clock::time_point began = std::chrono::steady_clock::now();
+        mutex.lock();
+        acquired = std::chrono::steady_clock::now();
+        uint64_t waited = elapsedNs(began, acquired);
+        stats.contended++;
+        stats.wait_ns += waited;
+        if (waited > stats.wait_max_ns) stats.wait_max_ns = waited;
+        stats.wait_histogram[bucketOf(waited)]++;
+    }
+    stats.acquisitions++;
+    holder = site;
+}
+
+void InstrumentedMutex::lock()
+{
+    lock(LockSite::LockOther);
+}
+
+void InstrumentedMutex::unlock()
+{
+    if (recording)
+    {
+        LockSiteStats& stats = sites[holder];
+        uint64_t held = elapsedNs(acquired, std::chrono::steady_clock::now());
+        stats.hold_ns += held;
+        if (held > stats.hold_max_ns) stats.hold_max_ns = held;
+        stats.hold_histogram[bucketOf(held)]++;
+    }
+    mutex.unlock();
+}
+
+const LockSiteStats& InstrumentedMutex::stats(LockSite site) const
+{
+    return sites[site];
+}
+
+std::string lockSiteToString(LockSite site)
+{
+    std::string str;
+    switch (site)
+    {
+        case LockSite::LockDispatch:
+            str = "core dispatch";
+            break;
+        case LockSite::LockTerminate:
+            str = "terminate push";
+            break;
+        case LockSite::LockBlock:
+            str = "i/o push";
+            break;
+        case LockSite::LockRequeue:
+            str = "slice requeue";
+            break;
+        case LockSite::LockPreemptCheck:
+            str = "preempt check";
+            break;
+        case LockSite::LockMainTick:
+            str = "main loop tick";
+            break;
+        case LockSite::LockRender:
+            str = "render";
+            break;
+        default:
+            str = "other";
+            break;
+    }
+    return str;
+}
+
+// Upper bound of the bucket holding the q-th quantile of `histogram`, capped at
+// the largest value seen (0 when empty)
+static uint64_t histogramQuantile(const uint64_t *histogram, uint64_t count, uint64_t max, double q)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(q * count);
+    uint64_t seen = 0;
+    int k;
+    for (k = 0; k < LOCK_HISTOGRAM_BUCKETS; k++)
+    {
+        seen += histogram[k];
+        if (seen > rank)
+        {
+            return std::min(2ULL << k, (unsigned long long)max);
+        }
+    }
+    return max;
+}
+
+static void printHistogram(const char *label, const uint64_t *histogram)
+{
+    printf("  %s:", label);
+    int k;
+    for (k = 0; k < LOCK_HISTOGRAM_BUCKETS; k++)
+    {
+        if (histogram[k] > 0)
+        {
+            printf(" <%llu:%llu", (unsigned long long)(2ULL << k), (unsigned long long)histogram[k]);
+        }
+    }
+    printf("\n");
+}
+
+void printLockReport(const InstrumentedMutex& mutex)
+{
+    printf("\nScheduler mutex contention (times in us):\n");
+    printf("| Site             |   Acquired | Contended |  Cont %% |   Wait total |  Wait p99 |  Wait max |   Hold total |  Hold p99 |  Hold max |\n");
+    printf("+------------------+------------+-----------+---------+--------------+-----------+-----------+--------------+-----------+-----------+\n");
+    int s;
+    for (s = 0; s < NUM_LOCK_SITES; s++)
+    {
+        const LockSiteStats& stats = mutex.stats((LockSite)s);
+        if (stats.acquisitions == 0)
+        {
+            continue;
+        }
+        printf("| %-16s | %10llu | %9llu | %6.2lf%% | %12.1lf | %9.1lf | %9.1lf | %12.1lf | %9.1lf | %9.1lf |\n",
+               lockSiteToString((LockSite)s).c_str(), (unsigned long long)stats.acquisitions,
+               (unsigned long long)stats.contended, 100.0 * stats.contended / stats.acquisitions,
+               stats.wait_ns / 1e3,
+               histogramQuantile(stats.wait_histogram, stats.contended, stats.wait_max_ns, 0.99) / 1e3,
+               stats.wait_max_ns / 1e3, stats.hold_ns / 1e3,
+               histogramQuantile(stats.hold_histogram, stats.acquisitions, stats.hold_max_ns, 0.99) / 1e3,
+               stats.hold_max_ns / 1e3);
+    }
+    printf("Histograms (<upper bound in ns:count):\n");
+    for (s = 0; s < NUM_LOCK_SITES; s++)
+    {
+        const LockSiteStats& stats = mutex.stats((LockSite)s);
+        if (stats.acquisitions == 0)
+        {
+            continue;
+        }
+        printf("%s\n", lockSiteToString((LockSite)s).c_str());
+        printHistogram("wait", stats.wait_histogram);
+        printHistogram("hold", stats.hold_histogram);
+    }
+}
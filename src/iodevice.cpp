@@ -0,0 +1,189 @@
+#include "iodevice.h"
+
+IoDevice::IoDevice(IoDiscipline discipline, uint32_t deadline, uint32_t seek)
+    : discipline(discipline), deadline(deadline), seek(seek), busy(false), head(0), service_end(0),
+      started(0), served(0), busy_ms(0), depth_area(0), max_depth(0), wait_total(0), wait_max(0),
+      first_time(0), last_change(0)
+{
+    active.process = NULL;
+}
+
+// Integrate the waiting-queue depth up to `now`
+void IoDevice::account(uint32_t now)
+{
+    if (first_time == 0)
+    {
+        first_time = now;
+        last_change = now;
+    }
+    if ((int32_t)(now - last_change) > 0)
+    {
+        depth_area += (uint64_t)queue.size() * (now - last_change);
+        last_change = now;
+    }
+}
+
+// Index of the waiting request to serve next
+size_t IoDevice::pick(uint32_t now) const
+{
+    size_t i, best = 0;
+    if (discipline == IoDiscipline::IoFifo)
+    {
+        return 0;
+    }
+    // deadline: a request that has waited too long goes first (the queue is in arrival order)
+    if (discipline == IoDiscipline::IoDeadline && now - queue[0].queued >= deadline)
+    {
+        return 0;
+    }
+    uint32_t best_distance = UINT32_MAX;
+    for (i = 0; i < queue.size(); i++)
+    {
+        uint32_t distance = (queue[i].position > head) ? queue[i].position - head : head - queue[i].position;
+        if (distance < best_distance)
+        {
+            best = i;
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
+// Put the next waiting request in service at `now`
+void IoDevice::start(uint32_t now)
+{
+    size_t i = pick(now);
+    active = queue[i];
+    queue.erase(queue.begin() + i);
+    busy = true;
+
+    uint32_t distance = (active.position > head) ? active.position - head : head - active.position;
+    uint32_t length = active.process->getCurrentBurstTime() + (uint32_t)((uint64_t)seek * distance / TRACKS);
+    head = active.position;
+    service_end = now + length;
+    busy_ms += length;
+
+    uint32_t waited = now - active.queued;
+    started++;
+    wait_total += waited;
+    wait_max = std::max(wait_max, waited);
+    active.process->addIoWait(waited);
+    // the process's i/o burst is measured from the start of service
+    active.process->setBurstStartTime(now);
+}
+
+void IoDevice::submit(Process *p, uint32_t now)
+{
+    account(now);
+    IoRequest request;
+    request.process = p;
+    request.queued = now;
+    request.position = (p->getPid() * 2654435761u + p->getCurrentBurst() * 40503u) % TRACKS;
+    queue.push_back(request);
+    max_depth = std::max<uint32_t>(max_depth, queue.size());
+    if (!busy)
+    {
+        start(now);
+    }
+}
+
+Process* IoDevice::complete(uint32_t now)
+{
+    if (!busy || (int32_t)(now - service_end) < 0)
+    {
+        return NULL;
+    }
+    Process *p = active.process;
+    uint32_t end = service_end;
+    account(end);
+    served++;
+    busy = false;
+    active.process = NULL;
+    if (!queue.empty())
+    {
+        start(end);
+    }
+    return p;
+}
+
+uint32_t IoDevice::busyUntil() const
+{
+    return busy ? service_end : UINT32_MAX;
+}
+
+size_t IoDevice::depth() const
+{
+    return queue.size() + (busy ? 1 : 0);
+}
+
+DeviceSummary IoDevice::summarize(uint32_t end_time) const
+{
+    DeviceSummary summary;
+    double span = (first_time == 0) ? 0.0 : (double)(end_time - first_time);
+    summary.discipline = discipline;
+    summary.served = served;
+    summary.busy_time = busy_ms / 1000.0;
+    summary.utilization = (span > 0) ? std::min(1.0, busy_ms / span) : 0.0;
+    summary.mean_depth = (span > 0) ? depth_area / span : 0.0;
+    summary.max_depth = max_depth;
+    summary.mean_wait = (started > 0) ? (double)wait_total / started : 0.0;
+    summary.max_wait = wait_max;
+    return summary;
+}
+
+void IoDevice::save(CheckpointWriter& out) const
+{
+    size_t i;
+    out.putU32(queue.size());
+    for (i = 0; i < queue.size(); i++)
+    {
+        out.putProcess(queue[i].process);
+        out.putU32(queue[i].queued);
+        out.putU32(queue[i].position);
+    }
+    out.putProcess(active.process);
+    out.putU32(active.queued);
+    out.putU32(active.position);
+    out.putBool(busy);
+    out.putU32(head);
+    out.putU32(service_end);
+    out.putU32(started);
+    out.putU32(served);
+    out.putU64(busy_ms);
+    out.putU64(depth_area);
+    out.putU32(max_depth);
+    out.putU64(wait_total);
+    out.putU32(wait_max);
+    out.putU32(first_time);
+    out.putU32(last_change);
+}
+
+void IoDevice::load(CheckpointReader& in)
+{
+    uint32_t n = in.getU32();
+    uint32_t i;
+    queue.clear();
+    for (i = 0; i < n && in.ok(); i++)
+    {
+        IoRequest request;
+        request.process = in.getProcess();
+        request.queued = in.getU32();
+        request.position = in.getU32();
+        queue.push_back(request);
+    }
+    active.process = in.getProcess();
+    active.queued = in.getU32();
+    active.position = in.getU32();
+    busy = in.getBool();
+    head = in.getU32();
+    service_end = in.getU32();
+    started = in.getU32();
+    served = in.getU32();
+    busy_ms = in.getU64();
+    depth_area = in.getU64();
+    max_depth = in.getU32();
+    wait_total = in.getU64();
+    wait_max = in.getU32();
+    first_time = in.getU32();
+    last_change = in.getU32();
+}
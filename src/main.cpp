@@ -1,43 +1,43 @@
 #include <iostream>
+#include <algorithm>
 #include <string>
-#include <list>
 #include <vector>
 #include <chrono>
 #include <thread>
 #include <mutex>
-#include <condition_variable>
 #include <unistd.h>
 #include "configreader.h"
 #include "process.h"
-
-// Shared data for all cores
-typedef struct SchedulerData {
-    std::mutex mutex;
-    std::condition_variable condition;
-    ScheduleAlgorithm algorithm;
-    uint32_t context_switch;
-    uint32_t time_slice;
-    std::list<Process*> ready_queue;
-    std::vector<Process*> terminated;
-    std::vector<Process*> io_q;
-    bool all_terminated;
-} SchedulerData;
-
-void coreRunProcesses(uint8_t core_id, SchedulerData *data);
-int printProcessOutput(std::vector<Process*>& processes, std::mutex& mutex);
+#include "options.h"
+#include "timeseries.h"
+#include "report.h"
+#include "scheduler.h"
+#include "simulator.h"
+#include "sweep.h"
+#include "replicate.h"
+
+template <typename Policy> void coreRunProcesses(uint8_t core_id, SchedulerData *data);
+int printProcessOutput(std::vector<Process*>& processes, InstrumentedMutex& mutex);
 void clearOutput(int num_lines);
-uint32_t currentTime();
 std::string processStateToString(Process::State state);
+void printResults(const RunInfo& info, const RunSummary& summary, const std::vector<Process*>& processes);
+void exportReport(const RunOptions& options, RunInfo& info, const RunSummary& summary,
+                  const std::vector<Process*>& processes, uint32_t start, uint32_t program_start);
+
+typedef void (*CoreLoop)(uint8_t core_id, SchedulerData *data);
+CoreLoop selectCoreLoop(ScheduleAlgorithm algorithm);
 
 int main(int argc, char **argv)
 {
     // ensure user entered a command line parameter for configuration file name
     uint32_t programStartTime = currentTime();
-    if (argc < 2)
+    RunOptions options;
+    if (!parseOptions(argc, argv, &options))
     {
-        std::cerr << "Error: must specify configuration file" << std::endl;
+        printUsage(argv[0]);
         exit(1);
     }
+    setClockSpeed(options.speed);
 
     // declare variables used throughout main
     int i;
@@ -45,26 +45,134 @@ int main(int argc, char **argv)
     std::vector<Process*> processes;
 
     // read configuration file for scheduling simulation
-    SchedulerConfig *config = readConfigFile(argv[1]);
+    SchedulerConfig *config = readConfigFile(options.config_file);
+    if (options.seed_set)
+    {
+        // as an option line too, so configurations derived from this one keep it
+        config->lottery_seed = options.seed;
+        config->option_lines.push_back("lottery_seed=" + std::to_string(options.seed));
+    }
+
+    // keep a copy of the configuration for the results report
+    RunInfo info;
+    info.engine = "realtime";
+    info.config_file = options.config_file;
+    info.deterministic = options.deterministic;
+    info.started_at = time(NULL);
+    info.speed = options.speed;
+    info.cores = config->cores;
+    info.algorithm = config->algorithm;
+    info.context_switch = config->context_switch;
+    info.time_slice = config->time_slice;
+    info.num_processes = config->num_processes;
+    info.numa_nodes = config->numa_nodes;
+    info.numa_policy = config->numa_policy;
+    info.core_speeds = config->core_speeds;
+    info.hetero_policy = config->hetero_policy;
+    info.rr_adaptive = (config->algorithm == ScheduleAlgorithm::RR) ? config->rr_adaptive : SliceMode::SliceStatic;
+    info.rr_target_overhead = config->rr_target_overhead;
+    info.rr_target_response = config->rr_target_response;
+
+    // parameter sweep: every combination in virtual time, one results table
+    if (options.sweep.enabled)
+    {
+        std::vector<SweepPoint> points = runSweep(config, options.sweep);
+        printSweep(points);
+        bool written = (options.report == ReportFormat::NoReport) ||
+                       writeSweep(options.report, options.report_file, points);
+        deleteConfig(config);
+        if (!written)
+        {
+            std::cerr << "Error: could not write " << options.report_file << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // algorithms side by side: one virtual-time run each, concurrently
+    if (options.compare.enabled)
+    {
+        SweepSpec spec;
+        spec.enabled = true;
+        spec.algorithms = options.compare.algorithms;
+        spec.jobs = (options.sweep.jobs > 0) ? options.sweep.jobs : spec.algorithms.size();
+        ScheduleAlgorithm baseline = options.compare.baseline_set ? options.compare.baseline : config->algorithm;
+        std::vector<ScheduleAlgorithm>::iterator found = std::find(spec.algorithms.begin(), spec.algorithms.end(),
+                                                                    baseline);
+        size_t baseline_index = (found == spec.algorithms.end()) ? 0 : found - spec.algorithms.begin();
+        std::vector<SweepPoint> points = runSweep(config, spec);
+        printComparison(points, baseline_index);
+        bool written = (options.report == ReportFormat::NoReport) ||
+                       writeSweep(options.report, options.report_file, points);
+        deleteConfig(config);
+        if (!written)
+        {
+            std::cerr << "Error: could not write " << options.report_file << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // Monte Carlo replication: seeded virtual-time replicas, means with 95% intervals
+    if (options.replicate.replicas > 0)
+    {
+        ReplicationResult result = runReplicas(config, options.replicate, options.sweep.jobs);
+        printReplication(options.replicate, result);
+        bool written = (options.report == ReportFormat::NoReport) ||
+                       writeReplication(options.report, options.report_file, options.replicate, result);
+        deleteConfig(config);
+        if (!written)
+        {
+            std::cerr << "Error: could not write " << options.report_file << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // virtual-time engine: the whole run on this thread, no live table
+    if (options.engine == Engine::VirtualTime)
+    {
+        info.engine = "virtual";
+        std::vector<TraceEvent> trace;
+        SimulationResult result = simulate(config, processes, options.trace_file.empty() ? NULL : &trace,
+                                           &options.checkpoint);
+        deleteConfig(config);
+        if (!result.error.empty())
+        {
+            std::cerr << "Error: " << result.error << std::endl;
+            for (i = 0; i < (int)processes.size(); i++)
+            {
+                delete processes[i];
+            }
+            return 1;
+        }
+        printResults(info, result.summary, processes);
+        exportReport(options, info, result.summary, processes, result.start, programStartTime);
+        if (!options.trace_file.empty() && !writeTrace(options.trace_file, trace))
+        {
+            std::cerr << "Error: could not write " << options.trace_file << std::endl;
+        }
+        for (i = 0; i < (int)processes.size(); i++)
+        {
+            delete processes[i];
+        }
+        return 0;
+    }
 
     // store configuration parameters in shared data object
     uint8_t num_cores = config->cores;
-    shared_data = new SchedulerData();
-    shared_data->algorithm = config->algorithm;
-    shared_data->context_switch = config->context_switch;
-    shared_data->time_slice = config->time_slice;
-    shared_data->all_terminated = false;
+    shared_data = createSchedulerData(config);
+    shared_data->mutex.enableStats(options.lock_stats);
 
     // create processes
     uint32_t start = currentTime();
     for (i = 0; i < config->num_processes; i++)
     {
-        Process *p = new Process(config->processes[i], start);
+        Process *p = createProcess(config, i, start);
         processes.push_back(p);
         if (p->getState() == Process::State::Ready)
         {
-            shared_data->ready_queue.push_back(p);
-            p->setIntoQueueTime(currentTime());
+            launchProcess(shared_data, p, start);
         }
     }
 
@@ -72,10 +180,11 @@ int main(int argc, char **argv)
     deleteConfig(config);
 
     // launch 1 scheduling thread per cpu core
+    CoreLoop core_loop = selectCoreLoop(shared_data->algorithm);
     std::thread *schedule_threads = new std::thread[num_cores];
     for (i = 0; i < num_cores; i++)
     {
-        schedule_threads[i] = std::thread(coreRunProcesses, i, shared_data);
+        schedule_threads[i] = std::thread(core_loop, i, shared_data);
     }
 
     // main thread work goes here:
@@ -83,15 +192,25 @@ int main(int argc, char **argv)
     int num_terminated = 0;
     uint32_t end_time = 0;
     uint32_t half_time = 0;
+    uint32_t last_boost = start;
+    TimeSeries *series = NULL;
+    if (options.sample_interval > 0)
+    {
+        series = new TimeSeries(options.sample_interval, options.sample_capacity);
+    }
+    // the main loop ticks 60 times per simulated second, as it does at normal
+    // speed (launches and i/o completions happen on ticks), within 60 to 2000
+    // ticks per wall second; the table is redrawn at most 60 times a wall second
+    useconds_t tick_us = std::max(500.0, std::min(16667.0, 16667.0 / options.speed));
+    std::chrono::steady_clock::time_point last_render = std::chrono::steady_clock::now();
     while (!(shared_data->all_terminated))
     {
-        // clear output from previous iteration
-        clearOutput(num_lines);
-
         // start new processes at their appropriate start time <-locked ready q
         {//LOCK   
-            std::lock_guard<std::mutex> lock(shared_data->mutex);
+            SiteLock lock(shared_data->mutex, LockSite::LockMainTick);
             uint32_t currTime = currentTime();
+            uint32_t io_count = 0;
+            uint32_t busy_count = 0;
             for(int i = 0; i < processes.size(); i++)
             {
                 bool preEmpt = false;
@@ -101,9 +220,7 @@ int main(int argc, char **argv)
                     //check if it should be started
                     if(processes[i]->getStartTime() <= (currTime - programStartTime))
                     {    
-                        processes[i]->setState(Process::State::Ready, currTime);
-                        shared_data->ready_queue.push_back(processes[i]);
-                        processes[i]->setIntoQueueTime(currentTime());
+                        launchProcess(shared_data, processes[i], currTime);
                     }
                 }
                 if (state == Process::State::Ready){
@@ -111,24 +228,29 @@ int main(int argc, char **argv)
                 }
                 if (state == Process::State::IO){
                     processes[i]->updateProcess(currentTime());
-                    if (processes[i]->getBurstTimeElapsed() >= processes[i]->getCurrentBurstTime()){
-                        processes[i]->updateCurrentBurst();
-                        processes[i]->setState(Process::State::Ready, currentTime());
-                        shared_data->ready_queue.push_back(processes[i]);
-                        processes[i]->setIntoQueueTime(currentTime());
-                    }
                 }
+                Process::State new_state = processes[i]->getState();
+                if (new_state == Process::State::IO) io_count++;
+                else if (new_state == Process::State::Running) busy_count++;
             }
 
-            // sort the ready queue (if needed - based on scheduling algorithm)
-            //check algorithm and relevant info of each item in ready q
-            if(shared_data->algorithm == ScheduleAlgorithm::SJF)
+            // move processes whose i/o finished back to the ready queue
+            ioComplete(shared_data, currTime);
+
+            // MLFQ priority boost: everything back to the top level (avoids starvation)
+            if (shared_data->mlfq != NULL && shared_data->mlfq_boost > 0 &&
+                currTime - last_boost >= shared_data->mlfq_boost)
             {
-                shared_data->ready_queue.sort(SjfComparator());
+                mlfqBoost(shared_data, processes);
+                last_boost = currTime;
             }
-            if(shared_data->algorithm == ScheduleAlgorithm::PP)
+
+            // RR adaptive: retune the time slice from what the last window looked like
+            if (shared_data->tuner != NULL)
             {
-                shared_data->ready_queue.sort(PpComparator());
+                shared_data->time_slice = shared_data->tuner->tick(currTime - start, readySize(shared_data),
+                                                                   busy_count, shared_data->switches,
+                                                                   shared_data->time_slice);
             }
 
             //check for half done and all done
@@ -141,16 +263,28 @@ int main(int argc, char **argv)
                 shared_data->all_terminated = true;
                 end_time = currentTime();
             }
+
+            // record the current window of the throughput time series
+            if (series != NULL)
+            {
+                series->observe(currTime - start, readySize(shared_data), io_count,
+                                busy_count, shared_data->terminated.size());
+            }
         }//UNLOCK
 
        
         // determine if all processes are in the terminated state <- release lock on ready q
 
-        // output process status table
-        num_lines = printProcessOutput(processes, shared_data->mutex);
+        // output process status table, replacing the previous one
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (shared_data->all_terminated || now - last_render >= std::chrono::microseconds(16667))
+        {
+            clearOutput(num_lines);
+            num_lines = printProcessOutput(processes, shared_data->mutex);
+            last_render = now;
+        }
 
-        // sleep 1/60th of a second
-        usleep(16667);
+        usleep(tick_us);
     }
 
 
@@ -171,239 +305,179 @@ int main(int argc, char **argv)
     //  - Average waiting time
 
 
-    double cpu_total = 0;
-    double turn_total = 0;
-    double wait_total = 0;
-    for(int i = 0; i < processes.size(); i++)
+    RunSummary summary = summarizeRun(processes, start, half_time, end_time);
+    finishSummary(shared_data, processes, end_time, &summary);
+    printResults(info, summary, processes);
+    if (options.lock_stats)
     {
-        cpu_total += processes[i]->getCpuTime();
-        turn_total += processes[i]->getTurnaroundTime();
-        wait_total += processes[i]->getWaitTime();
+        printLockReport(shared_data->mutex);
     }
 
-    double prog_runtime = (end_time - start)/1000.0;
-    double first_runtime = (half_time - start)/1000.0;
-    double second_runtime = (end_time - half_time)/1000.0;
-    double cpu_percent = (cpu_total/prog_runtime)*100.0;
-    double overall_throughput = processes.size()/prog_runtime;
-    double first_throughput = (processes.size()/2)/first_runtime;
-    double second_throughput = (processes.size()/2)/second_runtime;
-    double turn_avg = turn_total/processes.size(); 
-    double wait_avg = wait_total/processes.size(); 
-
-    std::cout << "CPU Utilization: " << cpu_percent << "%" << std::endl;
-    std::cout << "Throughput - Overall Average: " << overall_throughput << std::endl;
-    std::cout << "Throughput - 1st Half Average: " << first_throughput << std::endl;
-    std::cout << "Throughput - 2nd Half Average: " << second_throughput << std::endl;
-    std::cout << "Average Turnaround Time: " << turn_avg << std::endl;
-    std::cout << "Average Wait Time: " << wait_avg << std::endl;
+    // export the throughput time series (warm-up, saturation and drain phases)
+    if (series != NULL)
+    {
+        series->finish(end_time - start);
+        if (series->writeCsv(options.timeseries_file, num_cores))
+        {
+            std::cout << "Time series (" << series->size() << " windows of " << options.sample_interval
+                      << " ms) written to " << options.timeseries_file << std::endl;
+        }
+        else
+        {
+            std::cerr << "Error: could not write " << options.timeseries_file << std::endl;
+        }
+        delete series;
+    }
+
+    exportReport(options, info, summary, processes, start, programStartTime);
 
     // Clean up before quitting program
+    for (i = 0; i < (int)processes.size(); i++)
+    {
+        delete processes[i];
+    }
     processes.clear();
+    deleteSchedulerData(shared_data);
 
     return 0;
 }
 
+template <typename Policy>
 void coreRunProcesses(uint8_t core_id, SchedulerData *shared_data)
 {
     // Work to be done by each core idependent of the other cores
     //  - Get process at front of ready queue
     //  - Simulate the processes running until one of the following:
     //     - CPU burst time has elapsed
-    //     - RR time slice has elapsed
-    //     - Process preempted by higher priority process
+    //     - Policy says the process must yield (time slice elapsed or
+    //       preempted by a better process)
     //  - Place the process back in the appropriate queue
     //     - I/O queue if CPU burst finished (and process not finished)
     //     - Terminated if CPU burst finished and no more bursts remain
-    //     - Ready queue if time slice elapsed or process was preempted
+    //     - Ready queue if the process yielded
     //  - Wait context switching time
     //  * Repeat until all processes in terminated state
-    Process *p;
-    p = NULL;
-    bool inRobin = false;
-    bool inProcess = false;
-    uint16_t currentBurst = -1;
-    uint32_t currentBurstTime = 0;
+    // State changes happen under the mutex so the main thread never sees a
+    // process half way through a transition.
+    Process *p = NULL;
+    CoreState core;
+    core.core = core_id;
+    core.slice = 0;
     uint32_t context_switch = shared_data->context_switch;
+    uint32_t migration = 0;
+    const Process *previous = NULL;
     while ((shared_data->all_terminated) != true){
-        int readySize = 0;
-        {//LOCK
-            std::lock_guard<std::mutex> lock(shared_data->mutex);
-            readySize = shared_data->ready_queue.size();
-        }//UNLOCK
-
         //If no process on core, check readyq
-        if ( readySize > 0 && p == NULL){
+        if (p == NULL){
             {//LOCK
-            std::lock_guard<std::mutex> lock(shared_data->mutex);
-            readySize = shared_data->ready_queue.size();
-            p = shared_data->ready_queue.front();
-            shared_data->ready_queue.pop_front();
+            SiteLock lock(shared_data->mutex, LockSite::LockDispatch);
+            p = dispatchCore<Policy>(shared_data, core, previous, currentTime(), &migration);
             }//UNLOCK
-
-            readySize = readySize - 1;
-            p->setState(Process::State::Running, currentTime());
-            p->setCpuCore(core_id);
-            if (p->isLaunched() != true){
-                p->setLaunched(true);
-                p->setLaunchTime(currentTime());
+            if (p == NULL){
+                continue;
             }
-            p->resetBurstTimeElapsed();
-            if (currentBurst != p->getCurrentBurst()){
-                p->setBurstStartTime(currentTime());
+            if (migration > 0){
+                uint32_t migrationStart = currentTime();
+                while (migration > currentTime() - migrationStart){};
             }
         }
-        if (shared_data->algorithm == ScheduleAlgorithm::RR && p != NULL){
-            p->setRRFlag();
+
+        uint32_t now = currentTime();
+        Process *leaving = p;
+        p->updateProcess<Policy>(now);
+        uint32_t ran = now - p->getSliceStartTime();
+        if (p->getRemainingTime() <= 0){
+            {//LOCK
+            SiteLock lock(shared_data->mutex, LockSite::LockTerminate);
+            terminateCore<Policy>(shared_data, core, p, ran, now);
+            }//UNLOCK
+            p = NULL;
         }
-        if (shared_data->algorithm == ScheduleAlgorithm::PP && p != NULL){
-            p->setPPFlag();
+        else if (p->getBurstTimeElapsed() >= p->getCurrentBurstTime()){
+            {//LOCK
+            SiteLock lock(shared_data->mutex, LockSite::LockBlock);
+            blockCore<Policy>(shared_data, core, p, ran, now);
+            }//UNLOCK
+            p = NULL;
         }
-        //Code for First Come First Serve
-        if (p != NULL && (shared_data->algorithm == ScheduleAlgorithm::FCFS || shared_data->algorithm == ScheduleAlgorithm::SJF)){
-            p->updateProcess(currentTime());
-            if (p->getRemainingTime() <= 0){               
-                p->setState(Process::State::Terminated, currentTime());
-                p->setCpuCore(-1);
-                p->updateProcess(currentTime());
-                {//LOCK
-                std::lock_guard<std::mutex> lock(shared_data->mutex);
-                shared_data->terminated.push_back(p);
-                }//UNLOCK
-                p = NULL;
-                uint32_t lastContextTime = currentTime();
-                while (context_switch >= currentTime() - lastContextTime){};
+        else if (Policy::preemptible){
+            if (Policy::locked_yield){
+                SiteLock lock(shared_data->mutex, LockSite::LockPreemptCheck);
+                if (Policy::shouldYield(shared_data, core, p, ran)){
+                    yieldCore<Policy>(shared_data, core, p, ran, now);
+                    p = NULL;
+                }
             }
-            else if (p->getBurstTimeElapsed() > p->getCurrentBurstTime()){
-                p->setState(Process::State::IO, currentTime());
-                p->updateCurrentBurst();
-                p->setBurstStartTime(currentTime());
-                p->resetBurstTimeElapsed();
-                p->updateProcess(currentTime());
-                p->setCpuCore(-1);
+            else if (Policy::shouldYield(shared_data, core, p, ran)){
+                SiteLock lock(shared_data->mutex, LockSite::LockRequeue);
+                yieldCore<Policy>(shared_data, core, p, ran, now);
                 p = NULL;
-                uint32_t lastContextTime = currentTime();
-                while (context_switch >= currentTime() - lastContextTime){};
             }
         }
-        //Code for Round Robin
-        if (p != NULL && shared_data->algorithm == ScheduleAlgorithm::RR){
-            //p->updateProcess(currentTime());
-            if (!inRobin){
-                p->setRoundRobinStartTime(currentTime());
-                inRobin = true;
-                currentBurst = p->getCurrentBurst();
-                currentBurstTime = p->getCurrentBurstTime();
-            }
-            p->updateProcess(currentTime());
-            if (p->getRemainingTime() <= 0){
-                p->setState(Process::State::Terminated, currentTime());
-                p->setCpuCore(-1);
-                p->updateProcess(currentTime());
-                {//LOCK
-                std::lock_guard<std::mutex> lock(shared_data->mutex);
-                shared_data->terminated.push_back(p);
-                }//UNLOCK
-                p = NULL;
-                uint32_t lastContextTime = currentTime();
-                while (context_switch >= currentTime() - lastContextTime){};
-            }
-            else if (p->getBurstTimeElapsed() > currentBurstTime){
-                p->setState(Process::State::IO, currentTime());
-                p->updateCurrentBurst();
-                p->setBurstStartTime(currentTime());
-                p->resetBurstTimeElapsed();
-                p->setCpuCore(-1);
-                p = NULL;
-                inRobin = false;
-                uint32_t lastContextTime = currentTime();
-                while (context_switch >= currentTime() - lastContextTime){};
-            }
-            else if ((currentTime() - p->getRoundRobinStartTime()) >= shared_data->time_slice){
-                p->setState(Process::State::Ready, currentTime());
-                p->updateBurstTime(p->getCurrentBurst(), currentTime() - p->getRoundRobinStartTime());
-                p->setIntoQueueTime(currentTime());
-                p->setCpuCore(-1);
-                {//LOCK
-                std::lock_guard<std::mutex> lock(shared_data->mutex);
-                shared_data->ready_queue.push_back(p);
-                }//UNLOCK
-                p = NULL;
-                inRobin = false;
-                uint32_t lastContextTime = currentTime();
-                while (context_switch >= currentTime() - lastContextTime){};
-            }
+
+        if (p == NULL){
+            previous = leaving;
+            uint32_t lastContextTime = currentTime();
+            while (context_switch >= currentTime() - lastContextTime){};
         }
-        //Code for PP
-        if(p != NULL && shared_data->algorithm == ScheduleAlgorithm::PP){
-            if (!inProcess){
-                p->setPPTime(currentTime());
-                inProcess = true;
-            }
-            p->updateProcess(currentTime());
-            //LOCK
-            {
-                std::lock_guard<std::mutex> lock(shared_data->mutex);
-                if (shared_data->ready_queue.size() != 0){
-                    
-                    Process *next = shared_data->ready_queue.front();
-                    if (next->getPriority() < p->getPriority()){
-                        next = NULL;
-                        p->setState(Process::State::Ready, currentTime());
-                        p->updateBurstTime(p->getCurrentBurst(), currentTime() - p->getPPTime());
-                        p->setIntoQueueTime(currentTime());
-                        p->setCpuCore(-1);
-                        shared_data->ready_queue.push_back(p);
-                        p = NULL;
-                        inProcess = false;
-                        uint32_t lastContextTime = currentTime();
-                        while (context_switch >= currentTime() - lastContextTime){};
-                    }
-                }
-            } //UNLOCK
-            if (p != NULL){
-                if (p->getRemainingTime() <= 0 ){
-                    p->setState(Process::State::Terminated, currentTime());
-                    p->setCpuCore(-1);
-                    p->updateProcess(currentTime());
-
-                    {//LOCK
-                    std::lock_guard<std::mutex> lock(shared_data->mutex);
-                    shared_data->terminated.push_back(p);
-                    }//UNLOCK
-                    p = NULL;
-                    inProcess = false;
-                    uint32_t lastContextTime = currentTime();
-                    while (context_switch >= currentTime() - lastContextTime){};
-                }
-                else if (p->getBurstTimeElapsed() > p->getCurrentBurstTime()){
-                    p->setState(Process::State::IO, currentTime());
-                    p->updateCurrentBurst();
-                    p->setBurstStartTime(currentTime());
-                    p->resetBurstTimeElapsed();
-                    p->updateProcess(currentTime());
-                    p->setCpuCore(-1);
-                    inProcess = false;
-                    p = NULL;
-                    uint32_t lastContextTime = currentTime();
-                    while (context_switch >= currentTime() - lastContextTime){};
-                }
-            }
-            
+    }
+}
 
+// Maps a policy type to its core loop instantiation
+struct CoreLoopSelector {
+    typedef CoreLoop result_type;
+
+    template <typename Policy>
+    CoreLoop run()
+    {
+        return coreRunProcesses<Policy>;
+    }
+};
+
+// Picks the core loop specialized for `algorithm` (done once, at startup)
+CoreLoop selectCoreLoop(ScheduleAlgorithm algorithm)
+{
+    CoreLoopSelector selector;
+    return withPolicy(algorithm, selector);
+}
+
+// Final statistics of a run, with the tables that apply to its configuration
+void printResults(const RunInfo& info, const RunSummary& summary, const std::vector<Process*>& processes)
+{
+    printSummary(summary);
+    if (isProportionalShare(info.algorithm))
+    {
+        printShares(processes);
+    }
+    if (!summary.devices.empty())
+    {
+        printDevices(summary.devices);
+    }
+    if (info.rr_adaptive != SliceMode::SliceStatic)
+    {
+        printSliceAdjustments(info, summary);
+    }
+}
+
+// Machine-readable results, if requested
+void exportReport(const RunOptions& options, RunInfo& info, const RunSummary& summary,
+                  const std::vector<Process*>& processes, uint32_t start, uint32_t program_start)
+{
+    if (options.report != ReportFormat::NoReport)
+    {
+        info.wall_seconds = (currentTime() - program_start)/1000.0/info.speed;
+        if (!writeReport(options.report, options.report_file, info, summary, processes, start))
+        {
+            std::cerr << "Error: could not write " << options.report_file << std::endl;
         }
-        
-        
-        
-      
-    }   
+    }
 }
 
-int printProcessOutput(std::vector<Process*>& processes, std::mutex& mutex)
+int printProcessOutput(std::vector<Process*>& processes, InstrumentedMutex& mutex)
 {
     int i;
     int num_lines = 2;
-    std::lock_guard<std::mutex> lock(mutex);
+    SiteLock lock(mutex, LockSite::LockRender);
     printf("|   PID | Priority |      State | Core | Turn Time | Wait Time | CPU Time | Remain Time |\n");
     printf("+-------+----------+------------+------+-----------+-----------+----------+-------------+\n");
     for (i = 0; i < processes.size(); i++)
@@ -439,13 +513,6 @@ void clearOutput(int num_lines)
     fflush(stdout);
 }
 
-uint32_t currentTime()
-{
-    uint32_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                  std::chrono::system_clock::now().time_since_epoch()).count();
-    return ms;
-}
-
 std::string processStateToString(Process::State state)
 {
     std::string str;
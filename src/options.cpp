@@ -0,0 +1,451 @@
+#include "options.h"
+
+// Splits "--name=value" into its name and value (value empty if no '=')
+static void splitOption(const std::string& arg, std::string& name, std::string& value)
+{
+    size_t eq = arg.find('=');
+    name = arg.substr(0, eq);
+    value = (eq == std::string::npos) ? "" : arg.substr(eq + 1);
+}
+
+static bool parseUnsigned(const std::string& name, const std::string& value, uint32_t *out)
+{
+    try
+    {
+        size_t used;
+        unsigned long n = std::stoul(value, &used);
+        if (used == value.size())
+        {
+            *out = n;
+            return true;
+        }
+    }
+    catch (const std::exception&)
+    {
+    }
+    std::cerr << "Error: " << name << " expects a non-negative integer" << std::endl;
+    return false;
+}
+
+// A percentage, stored as a fraction
+static bool parsePercent(const std::string& name, const std::string& value, double *out)
+{
+    try
+    {
+        size_t used;
+        double percent = std::stod(value, &used);
+        if (used == value.size() && percent >= 0 && percent < 100)
+        {
+            *out = percent / 100.0;
+            return true;
+        }
+    }
+    catch (const std::exception&)
+    {
+    }
+    std::cerr << "Error: " << name << " expects a percentage from 0 up to 100" << std::endl;
+    return false;
+}
+
+// A clock rate: a positive multiple of real time, at most 1000
+static bool parseSpeed(const std::string& name, const std::string& value, double *out)
+{
+    try
+    {
+        size_t used;
+        double speed = std::stod(value, &used);
+        if (used == value.size() && speed > 0 && speed <= 1000)
+        {
+            *out = speed;
+            return true;
+        }
+    }
+    catch (const std::exception&)
+    {
+    }
+    std::cerr << "Error: " << name << " expects a speed above 0 and up to 1000" << std::endl;
+    return false;
+}
+
+// A list of values and ranges, e.g. "5,10-50:10" (range step defaults to 1)
+static bool parseRangeList(const std::string& name, const std::string& value, std::vector<uint32_t> *out)
+{
+    std::string item;
+    std::stringstream ss(value);
+    out->clear();
+    while (std::getline(ss, item, ','))
+    {
+        uint32_t first, last, step = 1;
+        size_t dash = item.find('-');
+        size_t colon = item.find(':');
+        if (dash == std::string::npos)
+        {
+            if (!parseUnsigned(name, item, &first)) return false;
+            out->push_back(first);
+            continue;
+        }
+        std::string last_str = item.substr(dash + 1, (colon == std::string::npos) ? std::string::npos : colon - dash - 1);
+        if (!parseUnsigned(name, item.substr(0, dash), &first) || !parseUnsigned(name, last_str, &last) ||
+            (colon != std::string::npos && !parseUnsigned(name, item.substr(colon + 1), &step)))
+        {
+            return false;
+        }
+        if (step == 0 || last < first)
+        {
+            std::cerr << "Error: " << name << " has an empty range '" << item << "'" << std::endl;
+            return false;
+        }
+        for (uint64_t v = first; v <= last; v += step)
+        {
+            out->push_back(v);
+        }
+    }
+    if (out->empty())
+    {
+        std::cerr << "Error: " << name << " expects a list of values" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Algorithm names separated by commas, or "all"
+static bool parseAlgorithms(const std::string& value, std::vector<ScheduleAlgorithm> *out)
+{
+    std::string item;
+    std::stringstream ss(value);
+    out->clear();
+    while (std::getline(ss, item, ','))
+    {
+        ScheduleAlgorithm algorithm;
+        if (item == "all")
+        {
+            for (int i = 0; i < NUM_ALGORITHMS; i++)
+            {
+                out->push_back((ScheduleAlgorithm)i);
+            }
+        }
+        else if (parseAlgorithm(item, &algorithm))
+        {
+            out->push_back(algorithm);
+        }
+        else
+        {
+            std::cerr << "Error: unknown algorithm '" << item << "'" << std::endl;
+            return false;
+        }
+    }
+    return !out->empty();
+}
+
+bool parseOptions(int argc, char **argv, RunOptions *options)
+{
+    options->config_file = NULL;
+    options->sample_interval = 0;
+    options->sample_capacity = 4096;
+    options->timeseries_file = "timeseries.csv";
+    options->report = ReportFormat::NoReport;
+    options->report_file = "";
+    options->engine = Engine::RealTime;
+    options->deterministic = false;
+    options->seed_set = false;
+    options->seed = 0;
+    options->trace_file = "";
+    options->lock_stats = false;
+    options->speed = 1.0;
+    options->sweep.enabled = false;
+    options->sweep.jobs = 0;
+    options->compare.enabled = false;
+    options->compare.baseline_set = false;
+    options->replicate.replicas = 0;
+    options->replicate.min_replicas = 5;
+    options->replicate.seed = 1;
+    options->replicate.jitter = 0.0;
+    options->replicate.precision = 0.0;
+    options->checkpoint.file = "";
+    options->checkpoint.every = 60000;
+    options->checkpoint.restore = "";
+
+    int i;
+    bool engine_set = false;
+    const char *sample_option = NULL;   // a time series option given (real time only)
+    std::string name, value;
+    for (i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0)
+        {
+            if (options->config_file != NULL)
+            {
+                std::cerr << "Error: more than one configuration file given" << std::endl;
+                return false;
+            }
+            options->config_file = argv[i];
+            continue;
+        }
+
+        splitOption(arg, name, value);
+        if (name == "--sample")
+        {
+            if (!parseUnsigned(name, value, &options->sample_interval)) return false;
+            sample_option = "--sample";
+        }
+        else if (name == "--sample-windows")
+        {
+            if (!parseUnsigned(name, value, &options->sample_capacity)) return false;
+            if (options->sample_capacity == 0)
+            {
+                std::cerr << "Error: --sample-windows must be at least 1" << std::endl;
+                return false;
+            }
+            sample_option = "--sample-windows";
+        }
+        else if (name == "--timeseries")
+        {
+            options->timeseries_file = value;
+            sample_option = "--timeseries";
+        }
+        else if (name == "--report")
+        {
+            if      (value == "json") options->report = ReportFormat::JsonReport;
+            else if (value == "csv")  options->report = ReportFormat::CsvReport;
+            else
+            {
+                std::cerr << "Error: --report expects json or csv" << std::endl;
+                return false;
+            }
+        }
+        else if (name == "--report-file")
+        {
+            options->report_file = value;
+        }
+        else if (name == "--engine")
+        {
+            engine_set = true;
+            if      (value == "realtime") options->engine = Engine::RealTime;
+            else if (value == "virtual")  options->engine = Engine::VirtualTime;
+            else
+            {
+                std::cerr << "Error: --engine expects realtime or virtual" << std::endl;
+                return false;
+            }
+        }
+        else if (name == "--deterministic")
+        {
+            options->deterministic = true;
+        }
+        else if (name == "--seed")
+        {
+            uint32_t seed;
+            if (!parseUnsigned(name, value, &seed)) return false;
+            options->seed = seed;
+            options->seed_set = true;
+        }
+        else if (name == "--trace")
+        {
+            if (value.empty())
+            {
+                std::cerr << "Error: --trace expects a file name" << std::endl;
+                return false;
+            }
+            options->trace_file = value;
+        }
+        else if (name == "--speed")
+        {
+            if (!parseSpeed(name, value, &options->speed)) return false;
+        }
+        else if (name == "--lock-stats")
+        {
+            options->lock_stats = true;
+        }
+        else if (name == "--sweep-algorithms")
+        {
+            if (!parseAlgorithms(value, &options->sweep.algorithms)) return false;
+            options->sweep.enabled = true;
+        }
+        else if (name == "--sweep-cores")
+        {
+            if (!parseRangeList(name, value, &options->sweep.cores)) return false;
+            for (size_t c = 0; c < options->sweep.cores.size(); c++)
+            {
+                if (options->sweep.cores[c] < 1 || options->sweep.cores[c] > 255)
+                {
+                    std::cerr << "Error: --sweep-cores values must be 1-255" << std::endl;
+                    return false;
+                }
+            }
+            options->sweep.enabled = true;
+        }
+        else if (name == "--sweep-slices")
+        {
+            if (!parseRangeList(name, value, &options->sweep.time_slices)) return false;
+            for (size_t t = 0; t < options->sweep.time_slices.size(); t++)
+            {
+                if (options->sweep.time_slices[t] < 1)
+                {
+                    std::cerr << "Error: --sweep-slices values must be at least 1" << std::endl;
+                    return false;
+                }
+            }
+            options->sweep.enabled = true;
+        }
+        else if (name == "--sweep-switches")
+        {
+            if (!parseRangeList(name, value, &options->sweep.context_switches)) return false;
+            options->sweep.enabled = true;
+        }
+        else if (name == "--compare")
+        {
+            if (!parseAlgorithms(value.empty() ? "all" : value, &options->compare.algorithms)) return false;
+            options->compare.enabled = true;
+        }
+        else if (name == "--compare-baseline")
+        {
+            if (!parseAlgorithm(value, &options->compare.baseline))
+            {
+                std::cerr << "Error: unknown algorithm '" << value << "'" << std::endl;
+                return false;
+            }
+            options->compare.baseline_set = true;
+        }
+        else if (name == "--jobs")
+        {
+            if (!parseUnsigned(name, value, &options->sweep.jobs)) return false;
+        }
+        else if (name == "--replicate")
+        {
+            if (!parseUnsigned(name, value, &options->replicate.replicas)) return false;
+        }
+        else if (name == "--replicate-min")
+        {
+            if (!parseUnsigned(name, value, &options->replicate.min_replicas)) return false;
+        }
+        else if (name == "--replicate-seed")
+        {
+            uint32_t seed;
+            if (!parseUnsigned(name, value, &seed)) return false;
+            options->replicate.seed = seed;
+        }
+        else if (name == "--replicate-jitter")
+        {
+            if (!parsePercent(name, value, &options->replicate.jitter)) return false;
+        }
+        else if (name == "--replicate-precision")
+        {
+            if (!parsePercent(name, value, &options->replicate.precision)) return false;
+        }
+        else if (name == "--checkpoint")
+        {
+            if (value.empty())
+            {
+                std::cerr << "Error: --checkpoint expects a file name" << std::endl;
+                return false;
+            }
+            options->checkpoint.file = value;
+        }
+        else if (name == "--checkpoint-every")
+        {
+            if (!parseUnsigned(name, value, &options->checkpoint.every)) return false;
+            if (options->checkpoint.every == 0)
+            {
+                std::cerr << "Error: --checkpoint-every must be at least 1" << std::endl;
+                return false;
+            }
+        }
+        else if (name == "--restore")
+        {
+            if (value.empty())
+            {
+                std::cerr << "Error: --restore expects a file name" << std::endl;
+                return false;
+            }
+            options->checkpoint.restore = value;
+        }
+        else
+        {
+            std::cerr << "Error: unknown option " << name << std::endl;
+            return false;
+        }
+    }
+
+    if (options->config_file == NULL)
+    {
+        std::cerr << "Error: must specify configuration file" << std::endl;
+        return false;
+    }
+    bool checkpointed = !options->checkpoint.file.empty() || !options->checkpoint.restore.empty();
+    const char *virtual_option = options->deterministic ? "--deterministic" :
+                                 !options->trace_file.empty() ? "--trace" :
+                                 checkpointed ? "--checkpoint and --restore" : NULL;
+    if (virtual_option != NULL)
+    {
+        if (engine_set && options->engine == Engine::RealTime)
+        {
+            std::cerr << "Error: " << virtual_option << " need the virtual-time engine" << std::endl;
+            return false;
+        }
+        options->engine = Engine::VirtualTime;
+    }
+    if ((options->replicate.replicas > 0) + options->sweep.enabled + options->compare.enabled > 1)
+    {
+        std::cerr << "Error: --replicate, --compare and the sweep options cannot be combined" << std::endl;
+        return false;
+    }
+    if (checkpointed && (options->replicate.replicas > 0 || options->sweep.enabled || options->compare.enabled))
+    {
+        std::cerr << "Error: --checkpoint and --restore apply to a single run" << std::endl;
+        return false;
+    }
+    const char *realtime_option = options->lock_stats ? "--lock-stats" :
+                                  (options->speed != 1.0) ? "--speed" : sample_option;
+    if (realtime_option != NULL && (options->engine == Engine::VirtualTime || options->replicate.replicas > 0 ||
+                                    options->sweep.enabled || options->compare.enabled))
+    {
+        std::cerr << "Error: " << realtime_option << " needs the real-time engine" << std::endl;
+        return false;
+    }
+    if (options->compare.baseline_set)
+    {
+        std::vector<ScheduleAlgorithm>& algorithms = options->compare.algorithms;
+        if (std::find(algorithms.begin(), algorithms.end(), options->compare.baseline) == algorithms.end())
+        {
+            algorithms.insert(algorithms.begin(), options->compare.baseline);
+        }
+    }
+    options->replicate.min_replicas = std::max(2u, options->replicate.min_replicas);
+    if (options->report != ReportFormat::NoReport && options->report_file.empty())
+    {
+        options->report_file = (options->report == ReportFormat::JsonReport) ? "report.json" : "report.csv";
+    }
+    return true;
+}
+
+void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " <config file> [options]" << std::endl;
+    std::cerr << "  --sample=<ms>           real time: record a throughput time series with windows of <ms>" << std::endl;
+    std::cerr << "  --sample-windows=<n>    real time: keep the last <n> windows (default 4096)" << std::endl;
+    std::cerr << "  --timeseries=<file>     real time: time series CSV output (default timeseries.csv)" << std::endl;
+    std::cerr << "  --report=json|csv       export run metadata, metrics and per-process results" << std::endl;
+    std::cerr << "  --report-file=<file>    report output (default report.json / report.csv, - for stdout)" << std::endl;
+    std::cerr << "  --engine=realtime|virtual  wall-clock threads (default) or a virtual-time simulation" << std::endl;
+    std::cerr << "  --deterministic         virtual time, report without wall-clock values (reproducible)" << std::endl;
+    std::cerr << "  --seed=<n>              random seed (overrides lottery_seed in the configuration)" << std::endl;
+    std::cerr << "  --trace=<file>          virtual time: write every scheduling event in order as CSV" << std::endl;
+    std::cerr << "  --speed=<n>             real time: run the clock <n> times faster (e.g. 10, or 0.5 for slower)" << std::endl;
+    std::cerr << "  --lock-stats            real time: report contention on the scheduler mutex at exit" << std::endl;
+    std::cerr << "  --checkpoint=<file>     virtual time: keep a snapshot of the run's state in <file>" << std::endl;
+    std::cerr << "  --checkpoint-every=<ms> simulated ms between checkpoints (default 60000)" << std::endl;
+    std::cerr << "  --restore=<file>        virtual time: resume the run from a checkpoint" << std::endl;
+    std::cerr << "  --sweep-algorithms=<list>  sweep: algorithms to run (names or all)" << std::endl;
+    std::cerr << "  --sweep-cores=<list>    sweep: core counts, e.g. 1-8 or 2,4,8" << std::endl;
+    std::cerr << "  --sweep-slices=<list>   sweep: time slices in ms, e.g. 10-200:10" << std::endl;
+    std::cerr << "  --sweep-switches=<list> sweep: context switch costs in ms" << std::endl;
+    std::cerr << "  --compare[=<list>]      run the algorithms (default all) side by side in virtual time" << std::endl;
+    std::cerr << "  --compare-baseline=<name>  compare: algorithm the others are shown relative to" << std::endl;
+    std::cerr << "  --jobs=<n>              sweep/compare/replicate: worker threads" << std::endl;
+    std::cerr << "  --replicate=<n>         run up to <n> seeded virtual-time replicas, report 95% intervals" << std::endl;
+    std::cerr << "  --replicate-min=<n>     replicas before the precision target is checked (default 5)" << std::endl;
+    std::cerr << "  --replicate-seed=<n>    seed of the first replica (default 1)" << std::endl;
+    std::cerr << "  --replicate-jitter=<%>  vary every burst and arrival time by up to <%> per replica" << std::endl;
+    std::cerr << "  --replicate-precision=<%>  stop once every interval is within <%> of its mean" << std::endl;
+}
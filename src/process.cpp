@@ -1,4 +1,5 @@
 #include "process.h"
+#include "checkpoint.h"
 #include "vector"
 
 // Process class methods
@@ -17,12 +18,31 @@ Process::Process(ProcessDetails details, uint32_t current_time)
         cpu_io_times[i] = details.burst_times[i];
     }
     priority = details.priority;
+    deadline = details.deadline;
+    // without an explicit share, priority 0-4 gets 500-100 tickets
+    tickets = (details.shares != 0) ? details.shares : (5 - std::min<uint8_t>(priority, 4)) * 100;
+    pass = 0;
+    entitled_time = 0;
+    entitlement_mark = 0;
+    predicted_burst = 0;
+    prediction_error = 0;
+    prediction_relative_error = 0;
+    predictions = 0;
     state = (start_time == 0) ? State::Ready : State::NotStarted;
+    launch_time = 0;
     if (state == State::Ready)
     {
         launch_time = current_time;
     }
     core = -1;
+    last_core = -1;
+    migrations = 0;
+    migration_time = 0;
+    home_node = details.home_node;
+    run_rate = 1.0;
+    local_time = 0;
+    remote_time = 0;
+    io_wait_time = 0;
     turn_time = 0;
     wait_time = 0;
     cpu_time = 0;
@@ -34,12 +54,14 @@ Process::Process(ProcessDetails details, uint32_t current_time)
     burstTimeElapsed = 0;
     launched = false;
     fromRunningToReady = false;
-    wait_times;
     waitTimeNow = 0;
-    rrFlag = 0;
-    roundRobinStartTime = 0;
-    ppTime = 0;
-    ppFlag = 0;
+    past_wait_time = 0;
+    slice_start_time = 0;
+    completed_cpu_time = 0;
+    completion_time = 0;
+    num_preemptions = 0;
+    queue_level = 0;
+    vruntime = 0;
     for (i = 0; i < num_bursts; i+=2)
     {
         remain_time += burst_times[i];
@@ -52,27 +74,12 @@ Process::~Process()
     delete[] burst_times;
 }
 
-void Process::setPPFlag(){
-    ppFlag = 1;
-}
-uint32_t Process::getPPTime() const {
-    return ppTime;
-}
-
-void Process::setPPTime(uint32_t current_time){
-    ppTime = current_time;
-}
-
-uint32_t Process::getRoundRobinStartTime() const {
-    return roundRobinStartTime;
-}
-
-void Process::setRoundRobinStartTime(uint32_t current_time){
-    roundRobinStartTime = current_time;
+uint32_t Process::getSliceStartTime() const {
+    return slice_start_time;
 }
 
-void Process::setRRFlag(){
-    rrFlag = 1;
+void Process::setSliceStartTime(uint32_t current_time){
+    slice_start_time = current_time;
 }
 
 uint16_t Process::getPid() const
@@ -122,6 +129,9 @@ void Process::setBurstStartTime(uint32_t current_time){
 }
 
 void Process::updateCurrentBurst(){
+    if (current_burst % 2 == 0){
+        completed_cpu_time += cpu_io_times[current_burst];
+    }
     current_burst++;
 }
 
@@ -133,6 +143,12 @@ uint32_t Process::getCurrentBurstTime() const {
     return cpu_io_times[current_burst];
 }
 
+// Ms of the current burst left when the current slice started (the whole
+// burst for policies that run it to completion)
+uint32_t Process::getBurstRemaining() const {
+    return burst_times[current_burst];
+}
+
 uint32_t Process::getBurstTimeElapsed() const
 {
     return burstTimeElapsed;
@@ -188,7 +204,13 @@ void Process::setLaunched(bool set){
 void Process::setState(State new_state, uint32_t current_time)
 {
     if (state == Process::State::Ready && new_state == Process::State::Running){
-        wait_times.push_back(waitTimeNow);
+        past_wait_time += waitTimeNow;
+    }
+    if (state == Process::State::Running && new_state == Process::State::Ready){
+        num_preemptions++;
+    }
+    if (new_state == Process::State::Terminated){
+        completion_time = current_time;
     }
     state = new_state;
 }
@@ -197,11 +219,193 @@ void Process::setLaunchTime(uint32_t current_time){
     launch_time = current_time;
 }
 
+uint32_t Process::getLaunchTime() const {
+    return launch_time;
+}
+
+uint32_t Process::getCompletionTime() const {
+    return completion_time;
+}
+
+uint32_t Process::getNumPreemptions() const {
+    return num_preemptions;
+}
+
+uint8_t Process::getQueueLevel() const {
+    return queue_level;
+}
+
+void Process::setQueueLevel(uint8_t level){
+    queue_level = level;
+}
+
+uint64_t Process::getVruntime() const {
+    return vruntime;
+}
+
+uint32_t Process::getDeadline() const {
+    return deadline;
+}
+
+// Deadline in ms after the simulation started (UINT32_MAX if the process has none)
+uint32_t Process::getAbsoluteDeadline() const {
+    return (deadline == 0) ? UINT32_MAX : start_time + deadline;
+}
+
+uint32_t Process::getTickets() const {
+    return tickets;
+}
+
+uint64_t Process::getPass() const {
+    return pass;
+}
+
+void Process::setPass(uint64_t new_pass){
+    pass = new_pass;
+}
+
+double Process::getEntitledTime() const {
+    return entitled_time / 1000.0;
+}
+
+void Process::startCompeting(double entitlement_per_ticket){
+    entitlement_mark = entitlement_per_ticket;
+}
+
+// Credit the entitlement accrued since startCompeting
+void Process::stopCompeting(double entitlement_per_ticket){
+    entitled_time += tickets * (entitlement_per_ticket - entitlement_mark);
+}
+
+double Process::getPredictedBurst() const {
+    return predicted_burst;
+}
+
+// Prediction for the current cpu burst minus the part already run (ms)
+double Process::getPredictedRemainingBurst() const {
+    double progress = cpu_io_times[current_burst] - burst_times[current_burst];
+    return (predicted_burst > progress) ? predicted_burst - progress : 0.0;
+}
+
+double Process::getPredictionError() const {
+    return prediction_error;
+}
+
+double Process::getPredictionRelativeError() const {
+    return prediction_relative_error;
+}
+
+uint32_t Process::getNumPredictions() const {
+    return predictions;
+}
+
+void Process::setPredictedBurst(double ms){
+    predicted_burst = ms;
+}
+
+// A cpu burst of `actual` ms finished: score the prediction, then
+// tau(n+1) = alpha * t(n) + (1 - alpha) * tau(n)
+void Process::observeBurst(uint32_t actual, double alpha){
+    double error = (actual > predicted_burst) ? actual - predicted_burst : predicted_burst - actual;
+    prediction_error += error;
+    if (actual > 0){
+        prediction_relative_error += error / actual;
+    }
+    predictions++;
+    predicted_burst = alpha * actual + (1.0 - alpha) * predicted_burst;
+}
+
+void Process::setVruntime(uint64_t new_vruntime){
+    vruntime = new_vruntime;
+}
+
 void Process::setCpuCore(int8_t core_num)
 {
     core = core_num;
+    if (core_num >= 0){
+        last_core = core_num;
+    }
 }
 
+int8_t Process::getLastCore() const
+{
+    return last_core;
+}
+
+uint32_t Process::getNumMigrations() const
+{
+    return migrations;
+}
+
+// Seconds spent refilling caches after migrations
+double Process::getMigrationTime() const
+{
+    return (double)migration_time / 1000.0;
+}
+
+uint8_t Process::getHomeNode() const
+{
+    return home_node;
+}
+
+// Seconds on a core of the home node
+double Process::getLocalTime() const
+{
+    return (double)local_time / 1000.0;
+}
+
+// Seconds on a core of another node
+double Process::getRemoteTime() const
+{
+    return (double)remote_time / 1000.0;
+}
+
+// Seconds on any core, whatever its speed (getCpuTime is the work done there)
+double Process::getCoreTime() const
+{
+    return (double)(local_time + remote_time) / 1000.0;
+}
+
+uint32_t Process::getIntoQueueTime() const
+{
+    return into_queue_time;
+}
+
+// Seconds spent queued for an i/o device
+double Process::getIoWaitTime() const
+{
+    return (double)io_wait_time / 1000.0;
+}
+
+void Process::addIoWait(uint32_t ms)
+{
+    io_wait_time += ms;
+}
+
+void Process::setRunRate(double rate)
+{
+    run_rate = rate;
+}
+
+void Process::addCoreTime(uint32_t ms, bool local)
+{
+    if (local){
+        local_time += ms;
+    }
+    else {
+        remote_time += ms;
+    }
+}
+
+// Dispatched on a different core than last time, costing `penalty` ms
+void Process::addMigration(uint32_t penalty)
+{
+    migrations++;
+    migration_time += penalty;
+}
+
+// Bookkeeping of a process that is not on a core (the core running a process
+// updates it with updateProcess<Policy>)
 void Process::updateProcess(uint32_t current_time)
 {
     // use `current_time` to update turnaround time, wait time, burst times, 
@@ -209,54 +413,9 @@ void Process::updateProcess(uint32_t current_time)
     if (state != Process::State::Terminated && launch_time != 0){
         turn_time = current_time - launch_time;
     }
-    if (state == Process::State::Running && rrFlag == 0){
-        uint32_t burstTimesSoFar = 0;
-        for (int i = current_burst-2; i >=0; i-=2){
-            burstTimesSoFar = burstTimesSoFar + cpu_io_times[i];
-        }
-        cpu_time = burstTimesSoFar + (current_time - burstStartTime);
-        remain_time = total_remain_time - cpu_time;
-        burstTimeElapsed = current_time - burstStartTime;
-
-    }
-    if (state == Process::State::Running && rrFlag == 1){
-        uint32_t burstTimesSoFar = 0;
-        uint32_t currentBurstTimesSoFar = 0;
-        if (cpu_io_times[current_burst] != burst_times[current_burst]){
-            burstTimesSoFar = cpu_io_times[current_burst] - burst_times[current_burst];
-            currentBurstTimesSoFar = cpu_io_times[current_burst] - burst_times[current_burst];
-        }
-        for (int i = current_burst-2; i >=0; i-=2){
-            burstTimesSoFar = burstTimesSoFar + cpu_io_times[i];
-        }
-        cpu_time = burstTimesSoFar + (current_time - roundRobinStartTime);
-        remain_time = total_remain_time - cpu_time;
-        burstTimeElapsed = currentBurstTimesSoFar + (current_time - roundRobinStartTime);
-
-    }
-    if (state == Process::State::Running && ppFlag == 1){
-        uint32_t burstTimesSoFar = 0;
-        uint32_t currentBurstTimesSoFar = 0;
-        if (cpu_io_times[current_burst] != burst_times[current_burst]){
-            burstTimesSoFar = cpu_io_times[current_burst] - burst_times[current_burst];
-            currentBurstTimesSoFar = cpu_io_times[current_burst] - burst_times[current_burst];
-        }
-        for (int i = current_burst-2; i >=0; i-=2){
-            burstTimesSoFar = burstTimesSoFar + cpu_io_times[i];
-        }
-        cpu_time = burstTimesSoFar + (current_time - ppTime);
-        remain_time = total_remain_time - cpu_time;
-        burstTimeElapsed = currentBurstTimesSoFar + (current_time - ppTime);
-
-    }
     if (state == Process::State::Ready){
-        uint32_t waitSums = 0;
-        waitTimeNow = 0;
-        for (int i = 0; i<wait_times.size(); i++){
-            waitSums = waitSums + wait_times.at(i);
-        }
         waitTimeNow = (current_time - into_queue_time);
-        wait_time = waitSums + waitTimeNow;
+        wait_time = past_wait_time + waitTimeNow;
     }
     if (state == Process::State::IO){
         burstTimeElapsed = current_time - burstStartTime;
@@ -269,7 +428,114 @@ void Process::updateProcess(uint32_t current_time)
 
 void Process::updateBurstTime(int burst_idx, uint32_t new_time)
 {
-    burst_times[burst_idx] = burst_times[burst_idx] - new_time;
+    // clamp: the caller's clock may have moved past the end of the burst
+    burst_times[burst_idx] = (new_time < burst_times[burst_idx]) ? burst_times[burst_idx] - new_time : 0;
+}
+
+void Process::save(CheckpointWriter& out) const
+{
+    int i;
+    out.putU16(pid);
+    out.putU16(num_bursts);
+    out.putU16(current_burst);
+    for (i = 0; i < num_bursts; i++)
+    {
+        out.putU32(burst_times[i]);
+        out.putU32(cpu_io_times[i]);
+    }
+    out.putU32(tickets);
+    out.putU64(pass);
+    out.putDouble(entitled_time);
+    out.putDouble(entitlement_mark);
+    out.putDouble(predicted_burst);
+    out.putDouble(prediction_error);
+    out.putDouble(prediction_relative_error);
+    out.putU32(predictions);
+    out.putU8(state);
+    out.putU8(core);
+    out.putU8(last_core);
+    out.putU32(migrations);
+    out.putU32(migration_time);
+    out.putDouble(run_rate);
+    out.putU32(local_time);
+    out.putU32(remote_time);
+    out.putU32(io_wait_time);
+    out.putU32(turn_time);
+    out.putU32(wait_time);
+    out.putU32(cpu_time);
+    out.putU32(remain_time);
+    out.putU32(total_remain_time);
+    out.putU32(into_queue_time);
+    out.putU32(launch_time);
+    out.putU32(lastCpuTime);
+    out.putU32(lastWaitTime);
+    out.putU32(burstStartTime);
+    out.putU32(burstTimeElapsed);
+    out.putBool(launched);
+    out.putBool(fromRunningToReady);
+    out.putU32(waitTimeNow);
+    out.putU32(past_wait_time);
+    out.putU32(slice_start_time);
+    out.putU32(completed_cpu_time);
+    out.putU32(completion_time);
+    out.putU32(num_preemptions);
+    out.putU8(queue_level);
+    out.putU64(vruntime);
+}
+
+// The process must have been created from the same details as the saved one
+void Process::load(CheckpointReader& in)
+{
+    int i;
+    if (in.getU16() != pid || in.getU16() != num_bursts)
+    {
+        in.fail();
+        return;
+    }
+    current_burst = in.getU16();
+    for (i = 0; i < num_bursts; i++)
+    {
+        burst_times[i] = in.getU32();
+        cpu_io_times[i] = in.getU32();
+    }
+    tickets = in.getU32();
+    pass = in.getU64();
+    entitled_time = in.getDouble();
+    entitlement_mark = in.getDouble();
+    predicted_burst = in.getDouble();
+    prediction_error = in.getDouble();
+    prediction_relative_error = in.getDouble();
+    predictions = in.getU32();
+    state = (State)in.getU8();
+    core = (int8_t)in.getU8();
+    last_core = (int8_t)in.getU8();
+    migrations = in.getU32();
+    migration_time = in.getU32();
+    run_rate = in.getDouble();
+    local_time = in.getU32();
+    remote_time = in.getU32();
+    io_wait_time = in.getU32();
+    turn_time = in.getU32();
+    wait_time = in.getU32();
+    cpu_time = (int32_t)in.getU32();
+    remain_time = (int32_t)in.getU32();
+    total_remain_time = in.getU32();
+    into_queue_time = in.getU32();
+    launch_time = in.getU32();
+    lastCpuTime = in.getU32();
+    lastWaitTime = in.getU32();
+    burstStartTime = in.getU32();
+    burstTimeElapsed = in.getU32();
+    launched = in.getBool();
+    fromRunningToReady = in.getBool();
+    waitTimeNow = in.getU32();
+    past_wait_time = in.getU32();
+    slice_start_time = in.getU32();
+    completed_cpu_time = in.getU32();
+    completion_time = in.getU32();
+    num_preemptions = in.getU32();
+    queue_level = in.getU8();
+    vruntime = in.getU64();
 }
 
 
@@ -282,6 +548,18 @@ bool SjfComparator::operator ()(const Process *p1, const Process *p2)
     return p1->getRemainingTime() < p2->getRemainingTime();
 }
 
+// PSJF/PSRTF - orders by predicted remaining cpu burst (pid breaks ties)
+bool PredictedComparator::operator ()(const Process *p1, const Process *p2) const
+{
+    double r1 = p1->getPredictedRemainingBurst();
+    double r2 = p2->getPredictedRemainingBurst();
+    if (r1 != r2)
+    {
+        return r1 < r2;
+    }
+    return p1->getPid() < p2->getPid();
+}
+
 // PP - comparator for sorting read queue based on priority
 bool PpComparator::operator ()(const Process *p1, const Process *p2)
 {
@@ -0,0 +1,301 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include "replicate.h"
+#include "simulator.h"
+#include "bufferedwriter.h"
+
+static const char *METRIC_NAMES[] = {"runtime_s", "cpu_utilization_pct", "throughput_overall",
+                                     "throughput_first_half", "throughput_second_half", "avg_turnaround_s",
+                                     "avg_wait_s", "wait_p50_s", "wait_p99_s", "wait_max_s", "switch_overhead",
+                                     "context_switches", "migrations", "deadline_misses"};
+static const size_t NUM_METRICS = sizeof(METRIC_NAMES) / sizeof(METRIC_NAMES[0]);
+
+// Shared state of the replica workers
+typedef struct ReplicaPool {
+    const SchedulerConfig *base;
+    const ReplicateSpec *spec;
+    std::vector<RunSummary> summaries;
+    std::vector<bool> done;
+    std::atomic<uint32_t> next;     // next replica to start
+    std::atomic<uint32_t> limit;    // replicas that may be started (lowered when the run converges)
+    std::mutex mutex;
+    uint32_t complete;              // replicas 0 .. complete-1 have all finished
+    uint32_t started;
+    bool converged;
+} ReplicaPool;
+
+static void metricValues(const RunSummary& s, double *values)
+{
+    values[0] = s.runtime;
+    values[1] = s.cpu_percent;
+    values[2] = s.overall_throughput;
+    values[3] = s.first_throughput;
+    values[4] = s.second_throughput;
+    values[5] = s.turn_avg;
+    values[6] = s.wait_avg;
+    values[7] = s.wait_p50;
+    values[8] = s.wait_p99;
+    values[9] = s.wait_max;
+    values[10] = s.switch_overhead;
+    values[11] = (double)s.context_switches;
+    values[12] = s.migrations;
+    values[13] = s.deadlines.misses;
+}
+
+// Two-sided 95% quantile of Student's t distribution with `df` degrees of
+// freedom: exact to three places up to 30, then a Cornish-Fisher expansion
+static double tQuantile95(uint32_t df)
+{
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                   2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                   2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (df >= 1 && df <= 30)
+    {
+        return table[df - 1];
+    }
+    double z = 1.959964;
+    double z3 = z * z * z;
+    return z + (z3 + z) / (4.0 * df) + (5 * z3 * z * z + 16 * z3 + 3 * z) / (96.0 * df * df);
+}
+
+// Intervals of every metric over the first `n` replicas
+static std::vector<MetricInterval> intervals(const std::vector<RunSummary>& summaries, uint32_t n)
+{
+    std::vector<MetricInterval> metrics(NUM_METRICS);
+    std::vector<double> values(n * NUM_METRICS);
+    uint32_t r;
+    size_t m;
+    for (r = 0; r < n; r++)
+    {
+        metricValues(summaries[r], &values[r * NUM_METRICS]);
+    }
+    for (m = 0; m < NUM_METRICS; m++)
+    {
+        MetricInterval& metric = metrics[m];
+        metric.name = METRIC_NAMES[m];
+        metric.mean = 0;
+        metric.min = values[m];
+        metric.max = values[m];
+        for (r = 0; r < n; r++)
+        {
+            double v = values[r * NUM_METRICS + m];
+            metric.mean += v;
+            metric.min = std::min(metric.min, v);
+            metric.max = std::max(metric.max, v);
+        }
+        metric.mean /= n;
+        double squares = 0;
+        for (r = 0; r < n; r++)
+        {
+            double d = values[r * NUM_METRICS + m] - metric.mean;
+            squares += d * d;
+        }
+        metric.stddev = (n > 1) ? std::sqrt(squares / (n - 1)) : 0.0;
+        metric.half_width = (n > 1) ? tQuantile95(n - 1) * metric.stddev / std::sqrt((double)n) : 0.0;
+    }
+    return metrics;
+}
+
+static bool precise(const std::vector<MetricInterval>& metrics, double precision)
+{
+    size_t m;
+    for (m = 0; m < metrics.size(); m++)
+    {
+        if (!(metrics[m].half_width <= precision * std::fabs(metrics[m].mean)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static RunSummary runReplica(const SchedulerConfig *base, const ReplicateSpec& spec, uint32_t replica)
+{
+    SchedulerConfig *config = deriveConfig(base, base->algorithm, base->cores, base->time_slice,
+                                           base->context_switch);
+    config->lottery_seed = spec.seed + replica;
+    if (spec.jitter > 0)
+    {
+        jitterWorkload(config, spec.jitter, spec.seed + replica);
+    }
+    std::vector<Process*> processes;
+    SimulationResult result = simulate(config, processes);
+    size_t p;
+    for (p = 0; p < processes.size(); p++)
+    {
+        delete processes[p];
+    }
+    deleteConfig(config);
+    return result.summary;
+}
+
+// Worker: simulate replicas until the limit is reached, checking the
+// precision target each time the finished prefix grows
+static void replicaWorker(ReplicaPool *pool)
+{
+    uint32_t r;
+    while ((r = pool->next++) < pool->limit)
+    {
+        RunSummary summary = runReplica(pool->base, *pool->spec, r);
+
+        //LOCK
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->summaries[r] = summary;
+        pool->done[r] = true;
+        pool->started++;
+        while (!pool->converged && pool->complete < pool->limit && pool->done[pool->complete])
+        {
+            pool->complete++;
+            if (pool->spec->precision > 0 && pool->complete >= pool->spec->min_replicas &&
+                precise(intervals(pool->summaries, pool->complete), pool->spec->precision))
+            {
+                pool->converged = true;
+                pool->limit = pool->complete;
+            }
+        }
+        //UNLOCK
+    }
+}
+
+ReplicationResult runReplicas(const SchedulerConfig *base, const ReplicateSpec& spec, uint32_t jobs)
+{
+    ReplicaPool pool;
+    pool.base = base;
+    pool.spec = &spec;
+    pool.summaries.resize(spec.replicas);
+    pool.done.assign(spec.replicas, false);
+    pool.next = 0;
+    pool.limit = spec.replicas;
+    pool.complete = 0;
+    pool.started = 0;
+    pool.converged = false;
+
+    if (spec.jitter == 0 && base->algorithm != ScheduleAlgorithm::LOTTERY)
+    {
+        std::cerr << "Warning: " << algorithmToString(base->algorithm) << " does not use the seed; without "
+                  << "--replicate-jitter every replica is identical" << std::endl;
+    }
+    if (jobs == 0)
+    {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    jobs = std::min(jobs, spec.replicas);
+    std::chrono::steady_clock::time_point began = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    uint32_t j;
+    for (j = 0; j < jobs; j++)
+    {
+        workers.push_back(std::thread(replicaWorker, &pool));
+    }
+    for (j = 0; j < jobs; j++)
+    {
+        workers[j].join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+    std::cerr << "Ran " << pool.started << " replicas on " << jobs << " threads in " << seconds << " s" << std::endl;
+
+    ReplicationResult result;
+    result.replicas = pool.limit;
+    result.started = pool.started;
+    result.converged = pool.converged;
+    result.metrics = intervals(pool.summaries, result.replicas);
+    return result;
+}
+
+void printReplication(const ReplicateSpec& spec, const ReplicationResult& result)
+{
+    printf("Replicas: %u (seeds %llu-%llu", result.replicas, (unsigned long long)spec.seed,
+           (unsigned long long)(spec.seed + result.replicas - 1));
+    if (spec.jitter > 0)
+    {
+        printf(", workload jitter +/-%.1lf%%", 100.0 * spec.jitter);
+    }
+    printf(")\n");
+    if (spec.precision > 0)
+    {
+        if (result.converged)
+        {
+            printf("Every interval within %.2lf%% of its mean after %u replicas\n", 100.0 * spec.precision,
+                   result.replicas);
+        }
+        else
+        {
+            printf("Precision target of %.2lf%% not reached in %u replicas\n", 100.0 * spec.precision,
+                   result.replicas);
+        }
+    }
+    printf("| Metric                 |        Mean |  95%% CI +/- |   Std Dev |         Min |         Max |\n");
+    printf("+------------------------+-------------+-------------+-----------+-------------+-------------+\n");
+    size_t m;
+    for (m = 0; m < result.metrics.size(); m++)
+    {
+        const MetricInterval& metric = result.metrics[m];
+        printf("| %-22s | %11.4lf | %11.4lf | %9.4lf | %11.4lf | %11.4lf |\n", metric.name, metric.mean,
+               metric.half_width, metric.stddev, metric.min, metric.max);
+    }
+}
+
+bool writeReplication(ReportFormat format, const std::string& filename, const ReplicateSpec& spec,
+                      const ReplicationResult& result)
+{
+    BufferedWriter out(filename);
+    if (!out.isOpen())
+    {
+        return false;
+    }
+    size_t m;
+    if (format == ReportFormat::JsonReport)
+    {
+        out.put("{\"replicas\": ").putUnsigned(result.replicas);
+        out.put(", \"simulated\": ").putUnsigned(result.started);
+        out.put(", \"converged\": ").put(result.converged ? "true" : "false");
+        out.put(", \"seed\": ").putUnsigned(spec.seed);
+        out.put(", \"jitter\": ").putDouble(spec.jitter, 4);
+        out.put(", \"precision\": ").putDouble(spec.precision, 4);
+        out.put(",\n  \"metrics\": {");
+        for (m = 0; m < result.metrics.size(); m++)
+        {
+            const MetricInterval& metric = result.metrics[m];
+            out.put(m == 0 ? "\n    \"" : ",\n    \"").put(metric.name).put("\": {\"mean\": ");
+            out.putMetric(metric.mean, true);
+            out.put(", \"ci95_half_width\": ");
+            out.putMetric(metric.half_width, true);
+            out.put(", \"stddev\": ");
+            out.putMetric(metric.stddev, true);
+            out.put(", \"min\": ");
+            out.putMetric(metric.min, true);
+            out.put(", \"max\": ");
+            out.putMetric(metric.max, true);
+            out.put('}');
+        }
+        out.put("\n  }\n}\n");
+    }
+    else
+    {
+        out.put("# replicas=").putUnsigned(result.replicas).put('\n');
+        out.put("# simulated=").putUnsigned(result.started).put('\n');
+        out.put("# converged=").put(result.converged ? "true" : "false").put('\n');
+        out.put("# seed=").putUnsigned(spec.seed).put('\n');
+        out.put("# jitter=").putDouble(spec.jitter, 4).put('\n');
+        out.put("# precision=").putDouble(spec.precision, 4).put('\n');
+        out.put("metric,mean,ci95_half_width,ci95_low,ci95_high,stddev,min,max\n");
+        for (m = 0; m < result.metrics.size(); m++)
+        {
+            const MetricInterval& metric = result.metrics[m];
+            double fields[] = {metric.mean, metric.half_width, metric.mean - metric.half_width,
+                               metric.mean + metric.half_width, metric.stddev, metric.min, metric.max};
+            out.put(metric.name);
+            size_t f;
+            for (f = 0; f < sizeof(fields) / sizeof(fields[0]); f++)
+            {
+                out.put(',');
+                out.putMetric(fields[f], false);
+            }
+            out.put('\n');
+        }
+    }
+    return out.flush();
+}
@@ -0,0 +1,689 @@
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <unistd.h>
+#include "report.h"
+#include "bufferedwriter.h"
+
+// Nearest-rank percentile of an ascending vector (q in [0, 1])
+static double percentile(const std::vector<double>& sorted, double q)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    size_t rank = (size_t)std::ceil(q * sorted.size());
+    return sorted[(rank > 0) ? rank - 1 : 0];
+}
+
+// Completion time minus absolute deadline in ms (process must have a deadline and have terminated)
+int64_t processLateness(const Process *p, uint32_t start)
+{
+    int64_t completion = (int32_t)(p->getCompletionTime() - start);
+    return completion - (int64_t)p->getAbsoluteDeadline();
+}
+
+static DeadlineSummary summarizeDeadlines(const std::vector<Process*>& processes, uint32_t start)
+{
+    DeadlineSummary deadlines;
+    std::vector<double> lateness;
+    double total = 0;
+    size_t i;
+    deadlines.misses = 0;
+    for (i = 0; i < processes.size(); i++)
+    {
+        if (processes[i]->getDeadline() == 0)
+        {
+            continue;
+        }
+        int64_t late = processLateness(processes[i], start);
+        if (late > 0)
+        {
+            deadlines.misses++;
+        }
+        lateness.push_back(late);
+        total += late;
+    }
+    std::sort(lateness.begin(), lateness.end());
+
+    deadlines.with_deadline = lateness.size();
+    deadlines.lateness_min = lateness.empty() ? 0.0 : lateness.front();
+    deadlines.lateness_mean = lateness.empty() ? 0.0 : total / lateness.size();
+    deadlines.lateness_p50 = percentile(lateness, 0.50);
+    deadlines.lateness_p90 = percentile(lateness, 0.90);
+    deadlines.lateness_p99 = percentile(lateness, 0.99);
+    deadlines.lateness_max = lateness.empty() ? 0.0 : lateness.back();
+    return deadlines;
+}
+
+static PredictionSummary summarizePredictions(const std::vector<Process*>& processes)
+{
+    PredictionSummary predictions;
+    double abs_total = 0;
+    double rel_total = 0;
+    size_t i;
+    predictions.bursts = 0;
+    for (i = 0; i < processes.size(); i++)
+    {
+        predictions.bursts += processes[i]->getNumPredictions();
+        abs_total += processes[i]->getPredictionError();
+        rel_total += processes[i]->getPredictionRelativeError();
+    }
+    predictions.mean_abs_error = (predictions.bursts > 0) ? abs_total / predictions.bursts : 0.0;
+    predictions.mean_rel_error = (predictions.bursts > 0) ? 100.0 * rel_total / predictions.bursts : 0.0;
+    return predictions;
+}
+
+// Mean |actual - predicted| of one process's bursts in ms
+static double meanPredictionError(const Process *p)
+{
+    return (p->getNumPredictions() > 0) ? p->getPredictionError() / p->getNumPredictions() : 0.0;
+}
+
+RunSummary summarizeRun(const std::vector<Process*>& processes, uint32_t start, uint32_t half_time, uint32_t end_time)
+{
+    RunSummary summary;
+    double turn_total = 0;
+    double wait_total = 0;
+    std::vector<double> waits;
+    summary.migrations = 0;
+    summary.migration_time = 0;
+    summary.local_time = 0;
+    summary.remote_time = 0;
+    summary.core_time = 0;
+    summary.work_time = 0;
+    for(int i = 0; i < processes.size(); i++)
+    {
+        summary.migrations += processes[i]->getNumMigrations();
+        summary.migration_time += processes[i]->getMigrationTime();
+        summary.local_time += processes[i]->getLocalTime();
+        summary.remote_time += processes[i]->getRemoteTime();
+        summary.core_time += processes[i]->getCoreTime();
+        summary.work_time += processes[i]->getCpuTime();
+        turn_total += processes[i]->getTurnaroundTime();
+        wait_total += processes[i]->getWaitTime();
+        waits.push_back(processes[i]->getWaitTime());
+    }
+    std::sort(waits.begin(), waits.end());
+
+    double first_runtime = (half_time - start)/1000.0;
+    double second_runtime = (end_time - half_time)/1000.0;
+    summary.runtime = (end_time - start)/1000.0;
+    summary.cpu_percent = (summary.core_time/summary.runtime)*100.0;
+    summary.overall_throughput = processes.size()/summary.runtime;
+    summary.first_throughput = (processes.size()/2)/first_runtime;
+    summary.second_throughput = (processes.size()/2)/second_runtime;
+    summary.turn_avg = turn_total/processes.size();
+    summary.wait_avg = wait_total/processes.size();
+    summary.wait_p50 = percentile(waits, 0.50);
+    summary.wait_p99 = percentile(waits, 0.99);
+    summary.wait_p999 = percentile(waits, 0.999);
+    summary.wait_max = waits.empty() ? 0.0 : waits.back();
+    summary.deadlines = summarizeDeadlines(processes, start);
+    summary.predictions = summarizePredictions(processes);
+    summary.context_switches = 0;
+    summary.switch_overhead = 0;
+    summary.final_slice = 0;
+    return summary;
+}
+
+void printSummary(const RunSummary& summary)
+{
+    std::cout << "CPU Utilization: " << summary.cpu_percent << "%" << std::endl;
+    if (summary.work_time != summary.core_time)
+    {
+        std::cout << "Core Time - busy " << summary.core_time << " s, work done " << summary.work_time
+                  << " s" << std::endl;
+    }
+    std::cout << "Throughput - Overall Average: " << summary.overall_throughput << std::endl;
+    std::cout << "Throughput - 1st Half Average: " << summary.first_throughput << std::endl;
+    std::cout << "Throughput - 2nd Half Average: " << summary.second_throughput << std::endl;
+    std::cout << "Average Turnaround Time: " << summary.turn_avg << std::endl;
+    std::cout << "Average Wait Time: " << summary.wait_avg << std::endl;
+    std::cout << "Wait Time - p50 " << summary.wait_p50 << ", p99 " << summary.wait_p99
+              << ", p99.9 " << summary.wait_p999 << ", max " << summary.wait_max << std::endl;
+    if (summary.migrations > 0)
+    {
+        std::cout << "Migrations: " << summary.migrations << " (" << summary.migration_time
+                  << " s cache refill)" << std::endl;
+    }
+    if (summary.remote_time > 0)
+    {
+        std::cout << "NUMA Core Time - local " << summary.local_time << " s, remote " << summary.remote_time
+                  << " s (" << 100.0 * summary.remote_time / (summary.local_time + summary.remote_time)
+                  << "% remote)" << std::endl;
+    }
+
+    if (summary.context_switches > 0)
+    {
+        std::cout << "Context Switches: " << summary.context_switches << " ("
+                  << 100.0 * summary.switch_overhead << "% of busy core time)" << std::endl;
+    }
+
+    const DeadlineSummary& d = summary.deadlines;
+    if (d.with_deadline > 0)
+    {
+        std::cout << "Deadline Misses: " << d.misses << " of " << d.with_deadline << " ("
+                  << (100.0 * d.misses / d.with_deadline) << "%)" << std::endl;
+        std::cout << "Lateness (ms) - min " << d.lateness_min << ", mean " << d.lateness_mean
+                  << ", p50 " << d.lateness_p50 << ", p90 " << d.lateness_p90 << ", p99 "
+                  << d.lateness_p99 << ", max " << d.lateness_max << std::endl;
+    }
+
+    const PredictionSummary& pr = summary.predictions;
+    if (pr.bursts > 0)
+    {
+        std::cout << "Burst Prediction Error: " << pr.mean_abs_error << " ms mean absolute, "
+                  << pr.mean_rel_error << "% mean relative (" << pr.bursts << " bursts)" << std::endl;
+    }
+}
+
+// Requested share = the process's fraction of the cpu its tickets entitled it
+// to while it competed, achieved share = its fraction of the cpu time consumed
+static void shareTotals(const std::vector<Process*>& processes, double *entitled, double *cpu)
+{
+    size_t i;
+    *entitled = 0;
+    *cpu = 0;
+    for (i = 0; i < processes.size(); i++)
+    {
+        *entitled += processes[i]->getEntitledTime();
+        *cpu += processes[i]->getCpuTime();
+    }
+}
+
+static double requestedShare(const Process *p, double total_entitled)
+{
+    return (total_entitled > 0) ? p->getEntitledTime() / total_entitled : 0.0;
+}
+
+static double achievedShare(const Process *p, double total_cpu)
+{
+    return (total_cpu > 0) ? p->getCpuTime() / total_cpu : 0.0;
+}
+
+void printShares(const std::vector<Process*>& processes)
+{
+    double total_entitled, total_cpu;
+    shareTotals(processes, &total_entitled, &total_cpu);
+    printf("|   PID | Tickets | Entitled | CPU Time | Requested | Achieved |\n");
+    printf("+-------+---------+----------+----------+-----------+----------+\n");
+    size_t i;
+    for (i = 0; i < processes.size(); i++)
+    {
+        const Process *p = processes[i];
+        printf("| %5u | %7u | %8.1lf | %8.1lf | %8.1lf%% | %7.1lf%% |\n", p->getPid(), p->getTickets(),
+               p->getEntitledTime(), p->getCpuTime(), 100.0 * requestedShare(p, total_entitled),
+               100.0 * achievedShare(p, total_cpu));
+    }
+}
+
+void printDevices(const std::vector<DeviceSummary>& devices)
+{
+    printf("| Device | Discipline | Served | Utilization | Avg Depth | Max Depth | Avg Wait | Max Wait |\n");
+    printf("+--------+------------+--------+-------------+-----------+-----------+----------+----------+\n");
+    size_t i;
+    for (i = 0; i < devices.size(); i++)
+    {
+        const DeviceSummary& d = devices[i];
+        printf("| %6zu | %10s | %6u | %10.1lf%% | %9.2lf | %9u | %6.0lfms | %6.0lfms |\n", i,
+               ioDisciplineToString(d.discipline).c_str(), d.served, 100.0 * d.utilization, d.mean_depth,
+               d.max_depth, d.mean_wait, d.max_wait);
+    }
+}
+
+// Fraction of busy core time (running + switching) lost to `switches` context switches
+double switchOverhead(const std::vector<Process*>& processes, uint64_t switches, uint32_t context_switch)
+{
+    double core_ms = 0;
+    size_t i;
+    for (i = 0; i < processes.size(); i++)
+    {
+        core_ms += 1000.0 * processes[i]->getCoreTime();
+    }
+    double switch_ms = (double)switches * context_switch;
+    return (core_ms + switch_ms > 0) ? switch_ms / (core_ms + switch_ms) : 0.0;
+}
+
+// Every change the adaptive RR controller made, and the slice it averaged over the run
+void printSliceAdjustments(const RunInfo& info, const RunSummary& summary)
+{
+    const std::vector<SliceAdjustment>& log = summary.slice_adjustments;
+    uint32_t end = (uint32_t)std::llround(summary.runtime * 1000.0);
+    double weighted = 0;
+    uint32_t from = 0;
+    uint32_t slice = info.time_slice;
+    size_t i;
+    for (i = 0; i < log.size(); i++)
+    {
+        weighted += (double)slice * (std::min(log[i].time, end) - std::min(from, end));
+        from = log[i].time;
+        slice = log[i].new_slice;
+    }
+    weighted += (double)slice * (end - std::min(from, end));
+
+    std::cout << "Adaptive Time Slice (" << sliceModeToString(info.rr_adaptive) << ", target ";
+    if (info.rr_adaptive == SliceMode::SliceOverhead) std::cout << 100.0 * info.rr_target_overhead << "% overhead";
+    else std::cout << info.rr_target_response << " ms response";
+    std::cout << "): " << log.size() << " adjustments, " << info.time_slice << " -> " << summary.final_slice
+              << " ms, time-weighted mean " << ((end > 0) ? weighted / end : (double)slice) << " ms" << std::endl;
+    if (log.empty())
+    {
+        return;
+    }
+    printf("|  Time ms | Old Slice | New Slice | Avg Ready | Overhead | Burst p80 |\n");
+    printf("+----------+-----------+-----------+-----------+----------+-----------+\n");
+    for (i = 0; i < log.size(); i++)
+    {
+        printf("| %8u | %7ums | %7ums | %9.2lf | %7.2lf%% | %7ums |\n", log[i].time, log[i].old_slice,
+               log[i].new_slice, log[i].ready, 100.0 * log[i].overhead, log[i].burst_p80);
+    }
+}
+
+// Times kept by Process as seconds, reported as whole milliseconds
+static int64_t toMs(double seconds)
+{
+    return (int64_t)std::llround(seconds * 1000.0);
+}
+
+// Absolute ms timestamps relative to `start` (-1 if the event never happened)
+static int64_t relativeMs(uint32_t time, uint32_t start)
+{
+    return (time == 0) ? -1 : (int64_t)(int32_t)(time - start);
+}
+
+static std::string isoTime(time_t t)
+{
+    char str[32];
+    struct tm utc;
+    gmtime_r(&t, &utc);
+    strftime(str, sizeof(str), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    return str;
+}
+
+static std::string hostName()
+{
+    char name[256];
+    if (gethostname(name, sizeof(name)) != 0)
+    {
+        return "unknown";
+    }
+    name[sizeof(name) - 1] = '\0';
+    return name;
+}
+
+static void writeJson(BufferedWriter& out, const RunInfo& info, const RunSummary& summary,
+                      const std::vector<Process*>& processes, uint32_t start)
+{
+    out.put("{\n  \"run\": {\"engine\": ").putJsonString(info.engine);
+    out.put(", \"config_file\": ").putJsonString(info.config_file);
+    if (info.deterministic)
+    {
+        out.put(", \"deterministic\": true");
+    }
+    else
+    {
+        out.put(", \"started_at\": ").putJsonString(isoTime(info.started_at));
+        out.put(", \"host\": ").putJsonString(hostName());
+        out.put(", \"host_threads\": ").putUnsigned(std::thread::hardware_concurrency());
+        out.put(", \"wall_seconds\": ");
+        out.putMetric(info.wall_seconds, true);
+        if (info.speed != 1.0)
+        {
+            out.put(", \"speed\": ");
+            out.putMetric(info.speed, true);
+        }
+    }
+
+    out.put("},\n  \"config\": {\"cores\": ").putUnsigned(info.cores);
+    out.put(", \"algorithm\": ").putJsonString(algorithmToString(info.algorithm));
+    out.put(", \"context_switch\": ").putUnsigned(info.context_switch);
+    out.put(", \"time_slice\": ").putUnsigned(info.time_slice);
+    out.put(", \"num_processes\": ").putUnsigned(info.num_processes);
+    out.put(", \"numa_nodes\": ").putUnsigned(info.numa_nodes);
+    out.put(", \"numa_policy\": ").putJsonString(numaPolicyToString(info.numa_policy));
+    out.put(", \"core_speeds\": [");
+    for (size_t c = 0; c < info.core_speeds.size(); c++)
+    {
+        if (c > 0) out.put(", ");
+        out.putMetric(info.core_speeds[c], true);
+    }
+    out.put("], \"hetero_policy\": ").putJsonString(heteroPolicyToString(info.hetero_policy));
+    out.put(", \"rr_adaptive\": ").putJsonString(sliceModeToString(info.rr_adaptive));
+
+    out.put("},\n  \"metrics\": {\"runtime_s\": ");
+    out.putMetric(summary.runtime, true);
+    out.put(", \"cpu_utilization_pct\": ");
+    out.putMetric(summary.cpu_percent, true);
+    out.put(", \"core_busy_s\": ");
+    out.putMetric(summary.core_time, true);
+    out.put(", \"cpu_work_s\": ");
+    out.putMetric(summary.work_time, true);
+    out.put(", \"throughput_overall\": ");
+    out.putMetric(summary.overall_throughput, true);
+    out.put(", \"throughput_first_half\": ");
+    out.putMetric(summary.first_throughput, true);
+    out.put(", \"throughput_second_half\": ");
+    out.putMetric(summary.second_throughput, true);
+    out.put(", \"avg_turnaround_s\": ");
+    out.putMetric(summary.turn_avg, true);
+    out.put(", \"avg_wait_s\": ");
+    out.putMetric(summary.wait_avg, true);
+    out.put(", \"wait_s\": {\"p50\": ");
+    out.putMetric(summary.wait_p50, true);
+    out.put(", \"p99\": ");
+    out.putMetric(summary.wait_p99, true);
+    out.put(", \"p99.9\": ");
+    out.putMetric(summary.wait_p999, true);
+    out.put(", \"max\": ");
+    out.putMetric(summary.wait_max, true);
+    out.put('}');
+    out.put(", \"migrations\": ").putUnsigned(summary.migrations);
+    out.put(", \"migration_penalty_s\": ");
+    out.putMetric(summary.migration_time, true);
+    out.put(", \"local_core_s\": ");
+    out.putMetric(summary.local_time, true);
+    out.put(", \"remote_core_s\": ");
+    out.putMetric(summary.remote_time, true);
+    out.put(", \"context_switches\": ").putUnsigned(summary.context_switches);
+    out.put(", \"switch_overhead\": ");
+    out.putMetric(summary.switch_overhead, true);
+    out.put(", \"final_time_slice\": ").putUnsigned(summary.final_slice);
+    const DeadlineSummary& d = summary.deadlines;
+    if (d.with_deadline > 0)
+    {
+        out.put(", \"deadline_processes\": ").putUnsigned(d.with_deadline);
+        out.put(", \"deadline_misses\": ").putUnsigned(d.misses);
+        out.put(", \"lateness_ms\": {\"min\": ");
+        out.putMetric(d.lateness_min, true);
+        out.put(", \"mean\": ");
+        out.putMetric(d.lateness_mean, true);
+        out.put(", \"p50\": ");
+        out.putMetric(d.lateness_p50, true);
+        out.put(", \"p90\": ");
+        out.putMetric(d.lateness_p90, true);
+        out.put(", \"p99\": ");
+        out.putMetric(d.lateness_p99, true);
+        out.put(", \"max\": ");
+        out.putMetric(d.lateness_max, true);
+        out.put('}');
+    }
+    const PredictionSummary& pr = summary.predictions;
+    if (pr.bursts > 0)
+    {
+        out.put(", \"predicted_bursts\": ").putUnsigned(pr.bursts);
+        out.put(", \"prediction_mae_ms\": ");
+        out.putMetric(pr.mean_abs_error, true);
+        out.put(", \"prediction_mape_pct\": ");
+        out.putMetric(pr.mean_rel_error, true);
+    }
+
+    out.put('}');
+    if (!summary.devices.empty())
+    {
+        out.put(",\n  \"devices\": [");
+        for (size_t d = 0; d < summary.devices.size(); d++)
+        {
+            const DeviceSummary& dev = summary.devices[d];
+            out.put(d == 0 ? "\n    " : ",\n    ");
+            out.put("{\"device\": ").putUnsigned(d);
+            out.put(", \"discipline\": ").putJsonString(ioDisciplineToString(dev.discipline));
+            out.put(", \"served\": ").putUnsigned(dev.served);
+            out.put(", \"busy_s\": ");
+            out.putMetric(dev.busy_time, true);
+            out.put(", \"utilization\": ");
+            out.putMetric(dev.utilization, true);
+            out.put(", \"mean_queue_depth\": ");
+            out.putMetric(dev.mean_depth, true);
+            out.put(", \"max_queue_depth\": ").putUnsigned(dev.max_depth);
+            out.put(", \"mean_wait_ms\": ");
+            out.putMetric(dev.mean_wait, true);
+            out.put(", \"max_wait_ms\": ");
+            out.putMetric(dev.max_wait, true);
+            out.put('}');
+        }
+        out.put("\n  ]");
+    }
+    if (info.rr_adaptive != SliceMode::SliceStatic)
+    {
+        out.put(",\n  \"slice_adjustments\": [");
+        for (size_t a = 0; a < summary.slice_adjustments.size(); a++)
+        {
+            const SliceAdjustment& adj = summary.slice_adjustments[a];
+            out.put(a == 0 ? "\n    " : ",\n    ");
+            out.put("{\"time_ms\": ").putUnsigned(adj.time);
+            out.put(", \"old_slice\": ").putUnsigned(adj.old_slice);
+            out.put(", \"new_slice\": ").putUnsigned(adj.new_slice);
+            out.put(", \"mean_ready\": ");
+            out.putMetric(adj.ready, true);
+            out.put(", \"overhead\": ");
+            out.putMetric(adj.overhead, true);
+            out.put(", \"burst_p80_ms\": ").putUnsigned(adj.burst_p80);
+            out.put('}');
+        }
+        out.put("\n  ]");
+    }
+    out.put(",\n  \"processes\": [");
+    bool shares = isProportionalShare(info.algorithm);
+    bool predictive = isPredictive(info.algorithm);
+    double total_entitled, total_cpu;
+    shareTotals(processes, &total_entitled, &total_cpu);
+    size_t i;
+    for (i = 0; i < processes.size(); i++)
+    {
+        const Process *p = processes[i];
+        out.put(i == 0 ? "\n    " : ",\n    ");
+        out.put("{\"pid\": ").putUnsigned(p->getPid());
+        out.put(", \"priority\": ").putUnsigned(p->getPriority());
+        out.put(", \"arrival_ms\": ").putUnsigned(p->getStartTime());
+        out.put(", \"first_dispatch_ms\": ").putSigned(relativeMs(p->getLaunchTime(), start));
+        out.put(", \"completion_ms\": ").putSigned(relativeMs(p->getCompletionTime(), start));
+        out.put(", \"cpu_ms\": ").putSigned(toMs(p->getCpuTime()));
+        out.put(", \"wait_ms\": ").putSigned(toMs(p->getWaitTime()));
+        out.put(", \"turnaround_ms\": ").putSigned(toMs(p->getTurnaroundTime()));
+        out.put(", \"preemptions\": ").putUnsigned(p->getNumPreemptions());
+        out.put(", \"migrations\": ").putUnsigned(p->getNumMigrations());
+        out.put(", \"migration_ms\": ").putSigned(toMs(p->getMigrationTime()));
+        out.put(", \"home_node\": ").putUnsigned(p->getHomeNode());
+        out.put(", \"local_ms\": ").putSigned(toMs(p->getLocalTime()));
+        out.put(", \"remote_ms\": ").putSigned(toMs(p->getRemoteTime()));
+        out.put(", \"io_wait_ms\": ").putSigned(toMs(p->getIoWaitTime()));
+        if (p->getDeadline() != 0)
+        {
+            out.put(", \"deadline_ms\": ").putUnsigned(p->getAbsoluteDeadline());
+            out.put(", \"lateness_ms\": ").putSigned(processLateness(p, start));
+        }
+        if (shares)
+        {
+            out.put(", \"tickets\": ").putUnsigned(p->getTickets());
+            out.put(", \"entitled_ms\": ").putSigned(toMs(p->getEntitledTime()));
+            out.put(", \"requested_share\": ");
+            out.putMetric(requestedShare(p, total_entitled), true);
+            out.put(", \"achieved_share\": ");
+            out.putMetric(achievedShare(p, total_cpu), true);
+        }
+        if (predictive)
+        {
+            out.put(", \"predicted_bursts\": ").putUnsigned(p->getNumPredictions());
+            out.put(", \"prediction_mae_ms\": ");
+            out.putMetric(meanPredictionError(p), true);
+        }
+        out.put('}');
+    }
+    out.put("\n  ]\n}\n");
+}
+
+// CSV: metadata as "# key=value" comment lines, then one row per process
+static void writeCsv(BufferedWriter& out, const RunInfo& info, const RunSummary& summary,
+                     const std::vector<Process*>& processes, uint32_t start)
+{
+    out.put("# run.engine=").put(info.engine).put('\n');
+    out.put("# run.config_file=").put(info.config_file).put('\n');
+    if (info.deterministic)
+    {
+        out.put("# run.deterministic=true\n");
+    }
+    else
+    {
+        out.put("# run.started_at=").put(isoTime(info.started_at)).put('\n');
+        out.put("# run.host=").put(hostName()).put('\n');
+        out.put("# run.host_threads=").putUnsigned(std::thread::hardware_concurrency()).put('\n');
+        out.put("# run.wall_seconds=").putDouble(info.wall_seconds, 6).put('\n');
+        if (info.speed != 1.0)
+        {
+            out.put("# run.speed=").putDouble(info.speed, 6).put('\n');
+        }
+    }
+    out.put("# config.cores=").putUnsigned(info.cores).put('\n');
+    out.put("# config.algorithm=").put(algorithmToString(info.algorithm)).put('\n');
+    out.put("# config.context_switch=").putUnsigned(info.context_switch).put('\n');
+    out.put("# config.time_slice=").putUnsigned(info.time_slice).put('\n');
+    out.put("# config.num_processes=").putUnsigned(info.num_processes).put('\n');
+    out.put("# config.numa_nodes=").putUnsigned(info.numa_nodes).put('\n');
+    out.put("# config.numa_policy=").put(numaPolicyToString(info.numa_policy)).put('\n');
+    out.put("# config.core_speeds=");
+    for (size_t c = 0; c < info.core_speeds.size(); c++)
+    {
+        if (c > 0) out.put(',');
+        out.putDouble(info.core_speeds[c], 3);
+    }
+    out.put('\n');
+    out.put("# config.hetero_policy=").put(heteroPolicyToString(info.hetero_policy)).put('\n');
+    out.put("# config.rr_adaptive=").put(sliceModeToString(info.rr_adaptive)).put('\n');
+    out.put("# metrics.runtime_s=").putMetric(summary.runtime, false).put('\n');
+    out.put("# metrics.cpu_utilization_pct=").putMetric(summary.cpu_percent, false).put('\n');
+    out.put("# metrics.core_busy_s=").putMetric(summary.core_time, false).put('\n');
+    out.put("# metrics.cpu_work_s=").putMetric(summary.work_time, false).put('\n');
+    out.put("# metrics.throughput_overall=").putMetric(summary.overall_throughput, false).put('\n');
+    out.put("# metrics.throughput_first_half=").putMetric(summary.first_throughput, false).put('\n');
+    out.put("# metrics.throughput_second_half=").putMetric(summary.second_throughput, false).put('\n');
+    out.put("# metrics.avg_turnaround_s=").putMetric(summary.turn_avg, false).put('\n');
+    out.put("# metrics.avg_wait_s=").putMetric(summary.wait_avg, false).put('\n');
+    out.put("# metrics.wait_s.p50=").putMetric(summary.wait_p50, false).put('\n');
+    out.put("# metrics.wait_s.p99=").putMetric(summary.wait_p99, false).put('\n');
+    out.put("# metrics.wait_s.p99.9=").putMetric(summary.wait_p999, false).put('\n');
+    out.put("# metrics.wait_s.max=").putMetric(summary.wait_max, false).put('\n');
+    out.put("# metrics.migrations=").putUnsigned(summary.migrations).put('\n');
+    out.put("# metrics.migration_penalty_s=").putMetric(summary.migration_time, false).put('\n');
+    out.put("# metrics.local_core_s=").putMetric(summary.local_time, false).put('\n');
+    out.put("# metrics.remote_core_s=").putMetric(summary.remote_time, false).put('\n');
+    out.put("# metrics.context_switches=").putUnsigned(summary.context_switches).put('\n');
+    out.put("# metrics.switch_overhead=").putMetric(summary.switch_overhead, false).put('\n');
+    out.put("# metrics.final_time_slice=").putUnsigned(summary.final_slice).put('\n');
+    for (size_t a = 0; a < summary.slice_adjustments.size(); a++)
+    {
+        const SliceAdjustment& adj = summary.slice_adjustments[a];
+        out.put("# slice.").putUnsigned(a).put('=').putUnsigned(adj.time).put("ms:").putUnsigned(adj.old_slice)
+           .put("->").putUnsigned(adj.new_slice).put('\n');
+    }
+    for (size_t d = 0; d < summary.devices.size(); d++)
+    {
+        const DeviceSummary& dev = summary.devices[d];
+        out.put("# device.").putUnsigned(d).put(".discipline=").put(ioDisciplineToString(dev.discipline)).put('\n');
+        out.put("# device.").putUnsigned(d).put(".served=").putUnsigned(dev.served).put('\n');
+        out.put("# device.").putUnsigned(d).put(".utilization=").putMetric(dev.utilization, false).put('\n');
+        out.put("# device.").putUnsigned(d).put(".mean_queue_depth=").putMetric(dev.mean_depth, false).put('\n');
+        out.put("# device.").putUnsigned(d).put(".max_queue_depth=").putUnsigned(dev.max_depth).put('\n');
+        out.put("# device.").putUnsigned(d).put(".mean_wait_ms=").putDouble(dev.mean_wait, 3).put('\n');
+        out.put("# device.").putUnsigned(d).put(".max_wait_ms=").putDouble(dev.max_wait, 3).put('\n');
+    }
+    const DeadlineSummary& d = summary.deadlines;
+    if (d.with_deadline > 0)
+    {
+        out.put("# metrics.deadline_processes=").putUnsigned(d.with_deadline).put('\n');
+        out.put("# metrics.deadline_misses=").putUnsigned(d.misses).put('\n');
+        out.put("# metrics.lateness_ms.min=").putDouble(d.lateness_min, 3).put('\n');
+        out.put("# metrics.lateness_ms.mean=").putDouble(d.lateness_mean, 3).put('\n');
+        out.put("# metrics.lateness_ms.p50=").putDouble(d.lateness_p50, 3).put('\n');
+        out.put("# metrics.lateness_ms.p90=").putDouble(d.lateness_p90, 3).put('\n');
+        out.put("# metrics.lateness_ms.p99=").putDouble(d.lateness_p99, 3).put('\n');
+        out.put("# metrics.lateness_ms.max=").putDouble(d.lateness_max, 3).put('\n');
+    }
+    const PredictionSummary& pr = summary.predictions;
+    if (pr.bursts > 0)
+    {
+        out.put("# metrics.predicted_bursts=").putUnsigned(pr.bursts).put('\n');
+        out.put("# metrics.prediction_mae_ms=").putDouble(pr.mean_abs_error, 3).put('\n');
+        out.put("# metrics.prediction_mape_pct=").putDouble(pr.mean_rel_error, 3).put('\n');
+    }
+
+    out.put("pid,priority,arrival_ms,first_dispatch_ms,completion_ms,cpu_ms,wait_ms,turnaround_ms,preemptions,"
+            "migrations,migration_ms,home_node,local_ms,remote_ms,io_wait_ms,"
+            "deadline_ms,lateness_ms,tickets,entitled_ms,requested_share,achieved_share,"
+            "predicted_bursts,prediction_mae_ms\n");
+    bool shares = isProportionalShare(info.algorithm);
+    bool predictive = isPredictive(info.algorithm);
+    double total_entitled, total_cpu;
+    shareTotals(processes, &total_entitled, &total_cpu);
+    size_t i;
+    for (i = 0; i < processes.size(); i++)
+    {
+        const Process *p = processes[i];
+        out.putUnsigned(p->getPid()).put(',');
+        out.putUnsigned(p->getPriority()).put(',');
+        out.putUnsigned(p->getStartTime()).put(',');
+        out.putSigned(relativeMs(p->getLaunchTime(), start)).put(',');
+        out.putSigned(relativeMs(p->getCompletionTime(), start)).put(',');
+        out.putSigned(toMs(p->getCpuTime())).put(',');
+        out.putSigned(toMs(p->getWaitTime())).put(',');
+        out.putSigned(toMs(p->getTurnaroundTime())).put(',');
+        out.putUnsigned(p->getNumPreemptions()).put(',');
+        out.putUnsigned(p->getNumMigrations()).put(',');
+        out.putSigned(toMs(p->getMigrationTime())).put(',');
+        out.putUnsigned(p->getHomeNode()).put(',');
+        out.putSigned(toMs(p->getLocalTime())).put(',');
+        out.putSigned(toMs(p->getRemoteTime())).put(',');
+        out.putSigned(toMs(p->getIoWaitTime())).put(',');
+        if (p->getDeadline() != 0)
+        {
+            out.putUnsigned(p->getAbsoluteDeadline()).put(',');
+            out.putSigned(processLateness(p, start));
+        }
+        else
+        {
+            out.put(',');
+        }
+        out.put(',');
+        if (shares)
+        {
+            out.putUnsigned(p->getTickets()).put(',');
+            out.putSigned(toMs(p->getEntitledTime())).put(',');
+            out.putMetric(requestedShare(p, total_entitled), false).put(',');
+            out.putMetric(achievedShare(p, total_cpu), false);
+        }
+        else
+        {
+            out.put(",,,");
+        }
+        out.put(',');
+        if (predictive)
+        {
+            out.putUnsigned(p->getNumPredictions()).put(',');
+            out.putDouble(meanPredictionError(p), 3);
+        }
+        else
+        {
+            out.put(',');
+        }
+        out.put('\n');
+    }
+}
+
+bool writeReport(ReportFormat format, const std::string& filename, const RunInfo& info,
+                 const RunSummary& summary, const std::vector<Process*>& processes, uint32_t start)
+{
+    BufferedWriter out(filename);
+    if (!out.isOpen())
+    {
+        return false;
+    }
+    if (format == ReportFormat::JsonReport)
+    {
+        writeJson(out, info, summary, processes, start);
+    }
+    else
+    {
+        writeCsv(out, info, summary, processes, start);
+    }
+    return out.flush();
+}
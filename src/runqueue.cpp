@@ -0,0 +1,796 @@
+#include <sstream>
+#include "runqueue.h"
+
+MlfqQueue::MlfqQueue(uint8_t num_levels) : levels(num_levels), nonempty(0), count(0)
+{
+}
+
+void MlfqQueue::push(Process *p)
+{
+    uint8_t level = p->getQueueLevel();
+    if (level >= levels.size())
+    {
+        level = levels.size() - 1;
+        p->setQueueLevel(level);
+    }
+    levels[level].push_back(p);
+    nonempty |= (1u << level);
+    count++;
+}
+
+Process* MlfqQueue::pop()
+{
+    int level = topLevel();
+    if (level < 0)
+    {
+        return NULL;
+    }
+    Process *p = levels[level].front();
+    levels[level].pop_front();
+    if (levels[level].empty())
+    {
+        nonempty &= ~(1u << level);
+    }
+    count--;
+    return p;
+}
+
+int MlfqQueue::topLevel() const
+{
+    return (nonempty == 0) ? -1 : __builtin_ctz(nonempty);
+}
+
+size_t MlfqQueue::size() const
+{
+    return count;
+}
+
+uint8_t MlfqQueue::numLevels() const
+{
+    return levels.size();
+}
+
+void MlfqQueue::boost()
+{
+    size_t i;
+    for (i = 1; i < levels.size(); i++)
+    {
+        while (!levels[i].empty())
+        {
+            Process *p = levels[i].front();
+            levels[i].pop_front();
+            p->setQueueLevel(0);
+            levels[0].push_back(p);
+        }
+    }
+    nonempty = (count > 0) ? 1u : 0u;
+}
+
+
+void MlfqQueue::save(CheckpointWriter& out) const
+{
+    size_t i, j;
+    out.putU8(levels.size());
+    for (i = 0; i < levels.size(); i++)
+    {
+        out.putU32(levels[i].size());
+        for (j = 0; j < levels[i].size(); j++)
+        {
+            out.putProcess(levels[i][j]);
+        }
+    }
+}
+
+void MlfqQueue::load(CheckpointReader& in)
+{
+    if (in.getU8() != levels.size())
+    {
+        in.fail();
+        return;
+    }
+    size_t i;
+    for (i = 0; i < levels.size() && in.ok(); i++)
+    {
+        uint32_t n = in.getU32();
+        uint32_t j;
+        for (j = 0; j < n && in.ok(); j++)
+        {
+            levels[i].push_back(in.getProcess());
+            nonempty |= (1u << i);
+            count++;
+        }
+    }
+}
+
+// Linux sched_prio_to_weight[] entries for nice -10, -5, 0, 5, 10
+static const uint32_t CFS_WEIGHTS[] = {9548, 3121, 1024, 335, 110};
+static const uint32_t CFS_NICE_0_WEIGHT = 1024;
+
+uint32_t cfsWeight(uint8_t priority)
+{
+    return CFS_WEIGHTS[(priority < 5) ? priority : 4];
+}
+
+// vruntime advanced by `ms` of cpu time at `weight`
+static uint64_t cfsScaledRuntime(uint32_t ms, uint32_t weight)
+{
+    return (uint64_t)ms * 1000 * CFS_NICE_0_WEIGHT / weight;
+}
+
+bool CfsComparator::operator ()(const Process *p1, const Process *p2) const
+{
+    if (p1->getVruntime() != p2->getVruntime())
+    {
+        return p1->getVruntime() < p2->getVruntime();
+    }
+    return p1->getPid() < p2->getPid();
+}
+
+CfsRunQueue::CfsRunQueue(uint32_t latency, uint32_t min_granularity, uint8_t cores)
+    : min_vruntime(0), queued_weight(0), running_weight(0), latency(latency),
+      min_granularity(min_granularity), cores(cores)
+{
+}
+
+void CfsRunQueue::push(Process *p)
+{
+    tree.insert(p);
+    queued_weight += cfsWeight(p->getPriority());
+}
+
+Process* CfsRunQueue::pop()
+{
+    if (tree.empty())
+    {
+        return NULL;
+    }
+    Process *p = *tree.begin();
+    tree.erase(tree.begin());
+    uint32_t weight = cfsWeight(p->getPriority());
+    queued_weight -= weight;
+    running_weight += weight;
+    if (p->getVruntime() > min_vruntime)
+    {
+        min_vruntime = p->getVruntime();
+    }
+    return p;
+}
+
+size_t CfsRunQueue::size() const
+{
+    return tree.size();
+}
+
+// New processes start at min_vruntime; sleepers keep their vruntime but get at
+// most half a latency period of credit, so they cannot monopolize a core
+void CfsRunQueue::place(Process *p, bool is_new)
+{
+    uint64_t floor = min_vruntime;
+    if (!is_new)
+    {
+        uint64_t credit = cfsScaledRuntime(latency / 2, CFS_NICE_0_WEIGHT);
+        floor = (floor > credit) ? floor - credit : 0;
+    }
+    if (is_new || p->getVruntime() < floor)
+    {
+        p->setVruntime(floor);
+    }
+}
+
+void CfsRunQueue::charge(Process *p, uint32_t ran)
+{
+    uint32_t weight = cfsWeight(p->getPriority());
+    p->setVruntime(p->getVruntime() + cfsScaledRuntime(ran, weight));
+    running_weight -= weight;
+}
+
+// Share of the target latency proportional to the process's weight; every
+// core runs one latency period, so the load is spread over `cores`
+uint32_t CfsRunQueue::timeSlice(const Process *p) const
+{
+    uint64_t load = queued_weight + running_weight;
+    uint64_t weight = cfsWeight(p->getPriority());
+    uint64_t slice = (load > 0) ? (uint64_t)latency * weight * cores / load : latency;
+    if (slice > latency) slice = latency;
+    if (slice < min_granularity) slice = min_granularity;
+    return slice;
+}
+
+// Kernel check_preempt_tick(): slice used up, or (after the minimum
+// granularity) the leftmost waiting process is more than a slice behind
+bool CfsRunQueue::shouldPreempt(const Process *p, uint32_t ran, uint32_t slice) const
+{
+    if (ran >= slice)
+    {
+        return true;
+    }
+    if (ran < min_granularity || tree.empty())
+    {
+        return false;
+    }
+    uint64_t current = p->getVruntime() + cfsScaledRuntime(ran, cfsWeight(p->getPriority()));
+    uint64_t leftmost = (*tree.begin())->getVruntime();
+    return current > leftmost && current - leftmost > cfsScaledRuntime(slice, CFS_NICE_0_WEIGHT);
+}
+
+
+void CfsRunQueue::save(CheckpointWriter& out) const
+{
+    out.putU64(min_vruntime);
+    out.putU64(queued_weight);
+    out.putU64(running_weight);
+    out.putU32(tree.size());
+    std::set<Process*, CfsComparator>::const_iterator it;
+    for (it = tree.begin(); it != tree.end(); it++)
+    {
+        out.putProcess(*it);
+    }
+}
+
+void CfsRunQueue::load(CheckpointReader& in)
+{
+    min_vruntime = in.getU64();
+    queued_weight = in.getU64();
+    running_weight = in.getU64();
+    uint32_t n = in.getU32();
+    uint32_t i;
+    for (i = 0; i < n && in.ok(); i++)
+    {
+        Process *p = in.getProcess();
+        if (p != NULL) tree.insert(p);
+    }
+}
+
+bool EdfComparator::operator ()(const Process *p1, const Process *p2) const
+{
+    if (p1->getAbsoluteDeadline() != p2->getAbsoluteDeadline())
+    {
+        return p1->getAbsoluteDeadline() < p2->getAbsoluteDeadline();
+    }
+    return p1->getPid() < p2->getPid();
+}
+
+bool SrtfComparator::operator ()(const Process *p1, const Process *p2) const
+{
+    if (p1->getRemainingTime() != p2->getRemainingTime())
+    {
+        return p1->getRemainingTime() < p2->getRemainingTime();
+    }
+    return p1->getPid() < p2->getPid();
+}
+
+RunningSet::RunningSet(uint8_t cores) : keys(cores, 0), present(cores, false), preempt(cores, false), pending(0)
+{
+}
+
+void RunningSet::add(uint8_t core, uint32_t remaining, uint32_t now)
+{
+    remove(core);
+    keys[core] = (uint64_t)now + remaining;
+    present[core] = true;
+    running.insert(std::make_pair(keys[core], core));
+}
+
+void RunningSet::remove(uint8_t core)
+{
+    if (present[core])
+    {
+        running.erase(std::make_pair(keys[core], core));
+        present[core] = false;
+    }
+    if (preempt[core])
+    {
+        preempt[core] = false;
+        pending--;
+    }
+}
+
+int RunningSet::preemptFor(uint32_t remaining, uint32_t now)
+{
+    if (running.empty() || running.size() + pending < keys.size())
+    {
+        return -1;
+    }
+    std::set<std::pair<uint64_t, uint8_t> >::iterator longest = --running.end();
+    uint64_t longest_remaining = (longest->first > now) ? longest->first - now : 0;
+    if (remaining >= longest_remaining)
+    {
+        return -1;
+    }
+    // leave the set so the next arrival picks a different victim
+    uint8_t core = longest->second;
+    running.erase(longest);
+    present[core] = false;
+    preempt[core] = true;
+    pending++;
+    return core;
+}
+
+bool RunningSet::preemptRequested(uint8_t core) const
+{
+    return preempt[core];
+}
+
+
+void RunningSet::save(CheckpointWriter& out) const
+{
+    size_t c;
+    out.putU8(keys.size());
+    for (c = 0; c < keys.size(); c++)
+    {
+        out.putU64(keys[c]);
+        out.putBool(present[c]);
+        out.putBool(preempt[c]);
+    }
+    out.putU32(pending);
+}
+
+// `running` holds exactly the present cores, so it is rebuilt from them
+void RunningSet::load(CheckpointReader& in)
+{
+    if (in.getU8() != keys.size())
+    {
+        in.fail();
+        return;
+    }
+    size_t c;
+    for (c = 0; c < keys.size(); c++)
+    {
+        keys[c] = in.getU64();
+        present[c] = in.getBool();
+        preempt[c] = in.getBool();
+        if (present[c])
+        {
+            running.insert(std::make_pair(keys[c], (uint8_t)c));
+        }
+    }
+    pending = in.getU32();
+}
+
+// Stride of a process with one ticket (strides are STRIDE_ONE / tickets)
+static const uint64_t STRIDE_ONE = 1 << 20;
+
+bool StrideComparator::operator ()(const Process *p1, const Process *p2) const
+{
+    if (p1->getPass() != p2->getPass())
+    {
+        return p1->getPass() < p2->getPass();
+    }
+    return p1->getPid() < p2->getPid();
+}
+
+StrideQueue::StrideQueue() : min_pass(0)
+{
+}
+
+void StrideQueue::push(Process *p)
+{
+    queue.insert(p);
+}
+
+Process* StrideQueue::pop()
+{
+    if (queue.empty())
+    {
+        return NULL;
+    }
+    Process *p = *queue.begin();
+    queue.erase(queue.begin());
+    if (p->getPass() > min_pass)
+    {
+        min_pass = p->getPass();
+    }
+    return p;
+}
+
+size_t StrideQueue::size() const
+{
+    return queue.size();
+}
+
+void StrideQueue::place(Process *p)
+{
+    if (p->getPass() < min_pass)
+    {
+        p->setPass(min_pass);
+    }
+}
+
+void StrideQueue::charge(Process *p, uint32_t ran)
+{
+    uint64_t stride = STRIDE_ONE / std::max<uint32_t>(p->getTickets(), 1);
+    p->setPass(p->getPass() + stride * ran);
+}
+
+
+void StrideQueue::save(CheckpointWriter& out) const
+{
+    out.putU64(min_pass);
+    out.putU32(queue.size());
+    std::set<Process*, StrideComparator>::const_iterator it;
+    for (it = queue.begin(); it != queue.end(); it++)
+    {
+        out.putProcess(*it);
+    }
+}
+
+void StrideQueue::load(CheckpointReader& in)
+{
+    min_pass = in.getU64();
+    uint32_t n = in.getU32();
+    uint32_t i;
+    for (i = 0; i < n && in.ok(); i++)
+    {
+        Process *p = in.getProcess();
+        if (p != NULL) queue.insert(p);
+    }
+}
+
+LotteryQueue::LotteryQueue(uint64_t seed) : total_tickets(0), count(0), random(seed)
+{
+}
+
+// Fenwick point update: slot's tickets change by `tickets`
+void LotteryQueue::add(size_t slot, int64_t tickets)
+{
+    size_t i;
+    for (i = slot + 1; i < tree.size(); i += i & (0 - i))
+    {
+        tree[i] += tickets;
+    }
+    total_tickets += tickets;
+}
+
+// Double the number of slots and rebuild the Fenwick tree in O(n)
+void LotteryQueue::grow()
+{
+    size_t old_size = slots.size();
+    size_t new_size = (old_size == 0) ? 64 : old_size * 2;
+    size_t i;
+    slots.resize(new_size, NULL);
+    tree.assign(new_size + 1, 0);
+    for (i = 0; i < new_size; i++)
+    {
+        tree[i + 1] += (slots[i] != NULL) ? slots[i]->getTickets() : 0;
+        size_t parent = (i + 1) + ((i + 1) & (0 - (i + 1)));
+        if (parent <= new_size)
+        {
+            tree[parent] += tree[i + 1];
+        }
+    }
+    for (i = new_size; i > old_size; i--)
+    {
+        free_slots.push_back(i - 1);
+    }
+}
+
+void LotteryQueue::push(Process *p)
+{
+    if (free_slots.empty())
+    {
+        grow();
+    }
+    size_t slot = free_slots.back();
+    free_slots.pop_back();
+    slots[slot] = p;
+    add(slot, std::max<uint32_t>(p->getTickets(), 1));
+    count++;
+}
+
+Process* LotteryQueue::pop()
+{
+    if (count == 0)
+    {
+        return NULL;
+    }
+    std::uniform_int_distribution<uint64_t> draw(0, total_tickets - 1);
+    uint64_t winner = draw(random);
+
+    // descend the Fenwick tree to the slot holding ticket number `winner`
+    size_t pos = 0;
+    size_t step = 1;
+    while (step * 2 < tree.size())
+    {
+        step *= 2;
+    }
+    for (; step > 0; step /= 2)
+    {
+        if (pos + step < tree.size() && tree[pos + step] <= winner)
+        {
+            pos += step;
+            winner -= tree[pos];
+        }
+    }
+
+    Process *p = slots[pos];
+    slots[pos] = NULL;
+    add(pos, -(int64_t)std::max<uint32_t>(p->getTickets(), 1));
+    free_slots.push_back(pos);
+    count--;
+    return p;
+}
+
+size_t LotteryQueue::size() const
+{
+    return count;
+}
+
+
+void LotteryQueue::save(CheckpointWriter& out) const
+{
+    size_t i;
+    out.putU32(slots.size());
+    for (i = 0; i < slots.size(); i++)
+    {
+        out.putProcess(slots[i]);
+        out.putU64(tree[i + 1]);
+    }
+    out.putU32(free_slots.size());
+    for (i = 0; i < free_slots.size(); i++)
+    {
+        out.putU32(free_slots[i]);
+    }
+    out.putU64(total_tickets);
+    out.putU32(count);
+    std::ostringstream state;
+    state << random;
+    out.putString(state.str());
+}
+
+void LotteryQueue::load(CheckpointReader& in)
+{
+    uint32_t n = in.getU32();
+    uint32_t i;
+    slots.clear();
+    tree.assign(1, 0);
+    for (i = 0; i < n && in.ok(); i++)
+    {
+        slots.push_back(in.getProcess());
+        tree.push_back(in.getU64());
+    }
+    n = in.getU32();
+    free_slots.clear();
+    for (i = 0; i < n && in.ok(); i++)
+    {
+        uint32_t slot = in.getU32();
+        if (slot >= slots.size()) in.fail();
+        free_slots.push_back(slot);
+    }
+    total_tickets = in.getU64();
+    count = in.getU32();
+    std::istringstream state(in.getString());
+    state >> random;
+    if (state.fail()) in.fail();
+}
+
+bool HrrnQueue::Entry::operator <(const Entry& other) const
+{
+    if (service != other.service)
+    {
+        return service < other.service;
+    }
+    if (queued != other.queued)
+    {
+        return queued < other.queued;
+    }
+    return process->getPid() < other.process->getPid();
+}
+
+HrrnQueue::HrrnQueue(uint32_t epoch) : epoch(std::max<uint32_t>(epoch, 1)), count(0)
+{
+}
+
+void HrrnQueue::push(Process *p, uint32_t now)
+{
+    Entry entry;
+    entry.service = std::max<uint32_t>((uint32_t)(p->getRemainingTime() * 1000.0 + 0.5), 1);
+    entry.queued = now;
+    entry.process = p;
+    Bucket& bucket = buckets[now / epoch];
+    if (bucket.entries.empty() || (int32_t)(now - bucket.oldest) < 0)
+    {
+        bucket.oldest = now;
+    }
+    bucket.entries.insert(entry);
+    count++;
+}
+
+Process* HrrnQueue::pop(uint32_t now)
+{
+    if (count == 0)
+    {
+        return NULL;
+    }
+    // compare (w1 + s1) / s1 against (w2 + s2) / s2 without dividing
+    std::map<uint32_t, Bucket>::iterator best = buckets.end();
+    std::set<Entry>::iterator best_entry;
+    uint64_t best_num = 0, best_den = 1;
+    std::map<uint32_t, Bucket>::iterator it;
+    for (it = buckets.begin(); it != buckets.end(); it++)
+    {
+        uint64_t longest_wait = now - it->second.oldest;
+        std::set<Entry>::iterator entry;
+        for (entry = it->second.entries.begin(); entry != it->second.entries.end(); entry++)
+        {
+            uint64_t den = entry->service;
+            if (best != buckets.end() && (longest_wait + den) * best_den <= best_num * den)
+            {
+                break;      // neither this entry nor any longer one can win
+            }
+            uint64_t num = (uint64_t)(now - entry->queued) + den;
+            if (best == buckets.end() || num * best_den > best_num * den)
+            {
+                best = it;
+                best_entry = entry;
+                best_num = num;
+                best_den = den;
+            }
+        }
+    }
+    Process *p = best_entry->process;
+    best->second.entries.erase(best_entry);
+    if (best->second.entries.empty())
+    {
+        buckets.erase(best);
+    }
+    count--;
+    return p;
+}
+
+size_t HrrnQueue::size() const
+{
+    return count;
+}
+
+
+void HrrnQueue::save(CheckpointWriter& out) const
+{
+    out.putU32(buckets.size());
+    std::map<uint32_t, Bucket>::const_iterator bucket;
+    for (bucket = buckets.begin(); bucket != buckets.end(); bucket++)
+    {
+        out.putU32(bucket->first);
+        out.putU32(bucket->second.entries.size());
+        std::set<Entry>::const_iterator entry;
+        for (entry = bucket->second.entries.begin(); entry != bucket->second.entries.end(); entry++)
+        {
+            out.putU32(entry->service);
+            out.putU32(entry->queued);
+            out.putProcess(entry->process);
+        }
+    }
+}
+
+void HrrnQueue::load(CheckpointReader& in)
+{
+    uint32_t num_buckets = in.getU32();
+    uint32_t b, e;
+    for (b = 0; b < num_buckets && in.ok(); b++)
+    {
+        uint32_t key = in.getU32();
+        Bucket& bucket = buckets[key];
+        uint32_t n = in.getU32();
+        for (e = 0; e < n && in.ok(); e++)
+        {
+            Entry entry;
+            entry.service = in.getU32();
+            entry.queued = in.getU32();
+            entry.process = in.getProcess();
+            if (entry.process != NULL)
+            {
+                // the oldest entry still queued: as tight a bound as the saved one
+                if (bucket.entries.empty() || (int32_t)(entry.queued - bucket.oldest) < 0)
+                {
+                    bucket.oldest = entry.queued;
+                }
+                bucket.entries.insert(entry);
+                count++;
+            }
+        }
+        if (bucket.entries.empty())
+        {
+            buckets.erase(key);
+        }
+    }
+}
+
+AgingQueue::AgingQueue(uint8_t num_levels, uint32_t aging) : levels(num_levels), aging(aging), count(0)
+{
+}
+
+uint32_t AgingQueue::effective(size_t level, uint32_t now) const
+{
+    uint32_t raised = (aging > 0) ? (now - levels[level].front().first) / aging : 0;
+    return (level > raised) ? level - raised : 0;
+}
+
+// Lowest effective priority; the process that has waited longer breaks ties
+int AgingQueue::bestLevel(uint32_t now) const
+{
+    int best = -1;
+    uint32_t best_priority = 0;
+    size_t i;
+    for (i = 0; i < levels.size(); i++)
+    {
+        if (levels[i].empty())
+        {
+            continue;
+        }
+        uint32_t priority = effective(i, now);
+        if (best < 0 || priority < best_priority ||
+            (priority == best_priority && levels[i].front().first < levels[best].front().first))
+        {
+            best = i;
+            best_priority = priority;
+        }
+    }
+    return best;
+}
+
+void AgingQueue::push(Process *p, uint32_t now)
+{
+    size_t level = std::min<size_t>(p->getPriority(), levels.size() - 1);
+    levels[level].push_back(std::make_pair(now, p));
+    count++;
+}
+
+Process* AgingQueue::pop(uint32_t now)
+{
+    int level = bestLevel(now);
+    if (level < 0)
+    {
+        return NULL;
+    }
+    Process *p = levels[level].front().second;
+    levels[level].pop_front();
+    count--;
+    return p;
+}
+
+uint32_t AgingQueue::bestPriority(uint32_t now) const
+{
+    int level = bestLevel(now);
+    return (level < 0) ? UINT32_MAX : effective(level, now);
+}
+
+size_t AgingQueue::size() const
+{
+    return count;
+}
+
+
+void AgingQueue::save(CheckpointWriter& out) const
+{
+    size_t i, j;
+    out.putU8(levels.size());
+    for (i = 0; i < levels.size(); i++)
+    {
+        out.putU32(levels[i].size());
+        for (j = 0; j < levels[i].size(); j++)
+        {
+            out.putU32(levels[i][j].first);
+            out.putProcess(levels[i][j].second);
+        }
+    }
+}
+
+void AgingQueue::load(CheckpointReader& in)
+{
+    if (in.getU8() != levels.size())
+    {
+        in.fail();
+        return;
+    }
+    size_t i;
+    for (i = 0; i < levels.size() && in.ok(); i++)
+    {
+        uint32_t n = in.getU32();
+        uint32_t j;
+        for (j = 0; j < n && in.ok(); j++)
+        {
+            uint32_t queued = in.getU32();
+            levels[i].push_back(std::make_pair(queued, in.getProcess()));
+            count++;
+        }
+    }
+}
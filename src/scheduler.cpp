@@ -0,0 +1,620 @@
+#include <algorithm>
+#include <chrono>
+#include "scheduler.h"
+
+// Creates the queues of a policy and binds its ready queue hooks
+struct QueueBinder {
+    typedef void result_type;
+    SchedulerData *shared_data;
+    const SchedulerConfig *config;
+
+    template <typename Policy>
+    void run()
+    {
+        Policy::create(shared_data, config);
+        shared_data->ready_push = Policy::push;
+        shared_data->ready_pop = Policy::pop;
+        shared_data->ready_size = Policy::size;
+    }
+};
+
+// Time the i/o burst `p` is doing ends (unlimited parallel i/o)
+static uint32_t ioEnd(const Process *p)
+{
+    return p->getBurstStartTime() + p->getCurrentBurstTime();
+}
+
+// Heap order of io_q without devices: the burst that ends first on top, ties by pid
+struct IoEndsLater {
+    bool operator ()(const Process *p1, const Process *p2) const
+    {
+        if (ioEnd(p1) != ioEnd(p2))
+        {
+            return ioEnd(p1) > ioEnd(p2);
+        }
+        return p1->getPid() > p2->getPid();
+    }
+};
+
+// Scheduler state for one run of `config` (queues for its algorithm only)
+SchedulerData* createSchedulerData(const SchedulerConfig *config)
+{
+    int i;
+    SchedulerData *shared_data = new SchedulerData();
+    shared_data->algorithm = config->algorithm;
+    shared_data->context_switch = config->context_switch;
+    shared_data->time_slice = config->time_slice;
+    shared_data->all_terminated = false;
+    shared_data->mlfq = NULL;
+    shared_data->mlfq_slice_factor = config->mlfq_slice_factor;
+    shared_data->mlfq_boost = config->mlfq_boost;
+    shared_data->mlfq_io_boost = config->mlfq_io_boost;
+    shared_data->migration_penalty = config->migration_penalty;
+    shared_data->affinity = config->affinity;
+    shared_data->topology = new Topology(config);
+    shared_data->numa_policy = config->numa_policy;
+    shared_data->numa_steal = config->numa_steal;
+    shared_data->hetero_policy = config->hetero_policy;
+    shared_data->idle.assign(config->cores, false);
+    for (i = 0; i < (int)config->io_devices.size(); i++)
+    {
+        shared_data->devices.push_back(new IoDevice(config->io_devices[i], config->io_deadline, config->io_seek));
+    }
+    shared_data->switches = 0;
+    shared_data->entitlement_per_ticket = 0;
+    shared_data->entitlement_time = 0;
+    shared_data->competing_tickets = 0;
+    shared_data->competing = 0;
+    shared_data->tuner = NULL;
+    shared_data->cfs = NULL;
+    shared_data->edf = NULL;
+    shared_data->stride = NULL;
+    shared_data->lottery = NULL;
+    shared_data->srtf = NULL;
+    shared_data->running = NULL;
+    shared_data->predicted = NULL;
+    shared_data->predict_alpha = config->predict_alpha;
+    shared_data->hrrn = NULL;
+    shared_data->aging = NULL;
+    QueueBinder binder;
+    binder.shared_data = shared_data;
+    binder.config = config;
+    withPolicy(config->algorithm, binder);
+    shared_data->virtual_clock = false;
+    shared_data->virtual_now = 0;
+    return shared_data;
+}
+
+void deleteSchedulerData(SchedulerData *shared_data)
+{
+    size_t i;
+    for (i = 0; i < shared_data->devices.size(); i++)
+    {
+        delete shared_data->devices[i];
+    }
+    delete shared_data->mlfq;
+    delete shared_data->cfs;
+    delete shared_data->edf;
+    delete shared_data->stride;
+    delete shared_data->lottery;
+    delete shared_data->srtf;
+    delete shared_data->running;
+    delete shared_data->predicted;
+    delete shared_data->hrrn;
+    delete shared_data->aging;
+    delete shared_data->tuner;
+    delete shared_data->topology;
+    delete shared_data;
+}
+
+// Rate of the real-time engine's clock: simulated ms per wall-clock ms (--speed)
+static double clock_speed = 1.0;
+static uint64_t clock_origin_us;    // wall clock when the rate was set
+static uint32_t clock_origin_ms;    // currentTime() at that moment
+
+static uint64_t wallMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+           std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void setClockSpeed(double speed)
+{
+    clock_origin_ms = currentTime();
+    clock_origin_us = wallMicros();
+    clock_speed = speed;
+}
+
+uint32_t currentTime()
+{
+    if (clock_speed == 1.0)
+    {
+        uint32_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::system_clock::now().time_since_epoch()).count();
+        return ms;
+    }
+    // counted from the origin so the clock stays continuous when the rate is set
+    uint64_t elapsed_ms = (uint64_t)((wallMicros() - clock_origin_us) * clock_speed / 1000.0);
+    return clock_origin_ms + (uint32_t)elapsed_ms;
+}
+
+// Time as the scheduler sees it: the wall clock, or the simulator's virtual clock
+uint32_t clockTime(const SchedulerData *shared_data)
+{
+    return shared_data->virtual_clock ? shared_data->virtual_now : currentTime();
+}
+
+// Scheduler-side results of a run: i/o devices, context switches and the adaptive slice log
+void finishSummary(SchedulerData *shared_data, const std::vector<Process*>& processes, uint32_t end_time,
+                   RunSummary *summary)
+{
+    size_t i;
+    for (i = 0; i < shared_data->devices.size(); i++)
+    {
+        summary->devices.push_back(shared_data->devices[i]->summarize(end_time));
+    }
+    summary->context_switches = shared_data->switches;
+    summary->switch_overhead = switchOverhead(processes, shared_data->switches, shared_data->context_switch);
+    summary->final_slice = shared_data->time_slice;
+    if (shared_data->tuner != NULL)
+    {
+        summary->slice_adjustments = shared_data->tuner->adjustments();
+    }
+}
+
+// Presence flag, then the structure; a restored run creates the same optional
+// structures from the same configuration, so the flags must agree
+template <typename T>
+static void saveOptional(const T *structure, CheckpointWriter& out)
+{
+    out.putBool(structure != NULL);
+    if (structure != NULL)
+    {
+        structure->save(out);
+    }
+}
+
+template <typename T>
+static void loadOptional(T *structure, CheckpointReader& in)
+{
+    if (in.getBool() != (structure != NULL))
+    {
+        in.fail();
+    }
+    else if (structure != NULL)
+    {
+        structure->load(in);
+    }
+}
+
+static void saveProcesses(const std::vector<Process*>& processes, CheckpointWriter& out)
+{
+    size_t i;
+    out.putU32(processes.size());
+    for (i = 0; i < processes.size(); i++)
+    {
+        out.putProcess(processes[i]);
+    }
+}
+
+template <typename Container>
+static void loadProcesses(Container& processes, CheckpointReader& in)
+{
+    uint32_t n = in.getU32();
+    uint32_t i;
+    processes.clear();
+    for (i = 0; i < n && in.ok(); i++)
+    {
+        processes.push_back(in.getProcess());
+    }
+}
+
+// Queue contents in order and everything else that changes during a run
+// (the configuration-derived fields and the topology are rebuilt from the
+// configuration on restore)
+void saveSchedulerData(const SchedulerData *shared_data, CheckpointWriter& out)
+{
+    size_t i;
+    out.putU32(shared_data->time_slice);
+    std::vector<Process*> ready(shared_data->ready_queue.begin(), shared_data->ready_queue.end());
+    saveProcesses(ready, out);
+    saveProcesses(shared_data->terminated, out);
+    saveProcesses(shared_data->io_q, out);
+    out.putBool(shared_data->all_terminated);
+    out.putU32(shared_data->idle.size());
+    for (i = 0; i < shared_data->idle.size(); i++)
+    {
+        out.putBool(shared_data->idle[i]);
+    }
+    out.putU64(shared_data->switches);
+    out.putDouble(shared_data->entitlement_per_ticket);
+    out.putU32(shared_data->entitlement_time);
+    out.putU64(shared_data->competing_tickets);
+    out.putU32(shared_data->competing);
+    out.putU32(shared_data->virtual_now);
+    saveOptional(shared_data->mlfq, out);
+    saveOptional(shared_data->cfs, out);
+    saveOptional(shared_data->edf, out);
+    saveOptional(shared_data->stride, out);
+    saveOptional(shared_data->lottery, out);
+    saveOptional(shared_data->srtf, out);
+    saveOptional(shared_data->running, out);
+    saveOptional(shared_data->predicted, out);
+    saveOptional(shared_data->hrrn, out);
+    saveOptional(shared_data->aging, out);
+    saveOptional(shared_data->tuner, out);
+    out.putU32(shared_data->devices.size());
+    for (i = 0; i < shared_data->devices.size(); i++)
+    {
+        shared_data->devices[i]->save(out);
+    }
+}
+
+// Into scheduler data freshly created from the checkpoint's configuration
+bool loadSchedulerData(SchedulerData *shared_data, CheckpointReader& in)
+{
+    size_t i;
+    shared_data->time_slice = in.getU32();
+    loadProcesses(shared_data->ready_queue, in);
+    loadProcesses(shared_data->terminated, in);
+    loadProcesses(shared_data->io_q, in);
+    if (shared_data->devices.empty())
+    {
+        std::make_heap(shared_data->io_q.begin(), shared_data->io_q.end(), IoEndsLater());
+    }
+    shared_data->all_terminated = in.getBool();
+    if (in.getU32() != shared_data->idle.size())
+    {
+        return false;
+    }
+    for (i = 0; i < shared_data->idle.size(); i++)
+    {
+        shared_data->idle[i] = in.getBool();
+    }
+    shared_data->switches = in.getU64();
+    shared_data->entitlement_per_ticket = in.getDouble();
+    shared_data->entitlement_time = in.getU32();
+    shared_data->competing_tickets = in.getU64();
+    shared_data->competing = in.getU32();
+    shared_data->virtual_now = in.getU32();
+    loadOptional(shared_data->mlfq, in);
+    loadOptional(shared_data->cfs, in);
+    loadOptional(shared_data->edf, in);
+    loadOptional(shared_data->stride, in);
+    loadOptional(shared_data->lottery, in);
+    loadOptional(shared_data->srtf, in);
+    loadOptional(shared_data->running, in);
+    loadOptional(shared_data->predicted, in);
+    loadOptional(shared_data->hrrn, in);
+    loadOptional(shared_data->aging, in);
+    loadOptional(shared_data->tuner, in);
+    if (in.getU32() != shared_data->devices.size())
+    {
+        return false;
+    }
+    for (i = 0; i < shared_data->devices.size(); i++)
+    {
+        shared_data->devices[i]->load(in);
+    }
+    return in.ok();
+}
+
+// Process `index` of `config`, created at `start`. Algorithms that do not use
+// priorities see every process at priority 0.
+Process* createProcess(const SchedulerConfig *config, int index, uint32_t start)
+{
+    ProcessDetails details = config->processes[index];
+    if (!usesPriority(config->algorithm))
+    {
+        details.priority = 0;
+    }
+    Process *p = new Process(details, start);
+    p->setPredictedBurst(config->predict_initial);
+    return p;
+}
+
+// Process `p` reached its start time: into the ready queue (caller must hold shared_data->mutex)
+void launchProcess(SchedulerData *shared_data, Process *p, uint32_t current_time)
+{
+    startCompeting(shared_data, p, current_time);
+    p->setState(Process::State::Ready, current_time);
+    if (shared_data->cfs != NULL) shared_data->cfs->place(p, true);
+    if (shared_data->stride != NULL) shared_data->stride->place(p);
+    readyPush(shared_data, p);
+    readyArrived(shared_data, p, current_time);
+    p->setIntoQueueTime(current_time);
+}
+
+// MLFQ priority boost: everything back to the top level (avoids starvation)
+// (caller must hold shared_data->mutex)
+void mlfqBoost(SchedulerData *shared_data, std::vector<Process*>& processes)
+{
+    size_t i;
+    for (i = 0; i < processes.size(); i++)
+    {
+        processes[i]->setQueueLevel(0);
+    }
+    shared_data->mlfq->boost();
+}
+
+// Ready queue access for code outside the core loop, through the hooks of
+// the algorithm's policy (caller must hold shared_data->mutex)
+void readyPush(SchedulerData *shared_data, Process *p)
+{
+    shared_data->ready_push(shared_data, p);
+}
+
+Process* readyPop(SchedulerData *shared_data, uint8_t core_id, const Process *previous)
+{
+    return shared_data->ready_pop(shared_data, core_id, previous);
+}
+
+size_t readySize(const SchedulerData *shared_data)
+{
+    return shared_data->ready_size(shared_data);
+}
+
+// Orders ready-queue positions by remaining cpu time, longest first
+struct LongerRemaining {
+    bool operator ()(const std::list<Process*>::iterator& a, const std::list<Process*>::iterator& b) const
+    {
+        return (*a)->getRemainingTime() > (*b)->getRemainingTime();
+    }
+};
+
+// Placement for the list-backed ready queue, in order of preference:
+//  - the first of the next `affinity` processes that last ran on `core_id`
+//    (not `previous`, the process that just left the core, or a round robin
+//    core would keep re-running it)
+//  - with a NUMA policy, the first process whose home is this core's node
+//  - with hetero_policy=fastest, of the processes about to be dispatched to
+//    the idle cores, the one whose rank by remaining work matches this
+//    core's rank by speed (longest work onto the fastest core)
+//  - the front; except that NUMA balance leaves a remote process for its own
+//    node until it has waited numa_steal ms (end() = stay idle)
+std::list<Process*>::iterator readyPlace(SchedulerData *shared_data, uint8_t core_id, const Process *previous)
+{
+    std::list<Process*>& queue = shared_data->ready_queue;
+    std::list<Process*>::iterator it = queue.begin();
+    uint32_t scanned;
+    for (scanned = 0; scanned < shared_data->affinity && it != queue.end(); scanned++, it++)
+    {
+        if ((*it)->getLastCore() == core_id && *it != previous)
+        {
+            return it;
+        }
+    }
+    if (queue.empty())
+    {
+        return queue.begin();
+    }
+    const Topology *topology = shared_data->topology;
+    if (shared_data->numa_policy != NumaPolicy::NumaIgnore)
+    {
+        for (it = queue.begin(); it != queue.end(); it++)
+        {
+            if (topology->isLocal((*it)->getHomeNode(), core_id))
+            {
+                return it;
+            }
+        }
+    }
+    if (shared_data->hetero_policy == HeteroPolicy::HeteroFastest)
+    {
+        size_t idle_cores = std::count(shared_data->idle.begin(), shared_data->idle.end(), true);
+        std::vector<std::list<Process*>::iterator> candidates;
+        for (it = queue.begin(); it != queue.end() && candidates.size() < idle_cores; it++)
+        {
+            candidates.push_back(it);
+        }
+        std::sort(candidates.begin(), candidates.end(), LongerRemaining());
+        size_t rank = std::min(fasterIdleCores(shared_data, core_id), candidates.size() - 1);
+        return candidates[rank];
+    }
+    if (shared_data->numa_policy == NumaPolicy::NumaBalance &&
+        clockTime(shared_data) - queue.front()->getIntoQueueTime() < shared_data->numa_steal)
+    {
+        return queue.end();
+    }
+    return queue.begin();
+}
+
+// hetero_policy=fastest: idle cores faster than `core_id` (equal speed: lower
+// id first), which get first pick of the ready work (0 when the policy is off)
+size_t fasterIdleCores(SchedulerData *shared_data, uint8_t core_id)
+{
+    if (shared_data->hetero_policy != HeteroPolicy::HeteroFastest)
+    {
+        return 0;
+    }
+    const Topology *topology = shared_data->topology;
+    double speed = topology->speed(core_id);
+    size_t faster = 0;
+    size_t i;
+    for (i = 0; i < shared_data->idle.size(); i++)
+    {
+        if (i != core_id && shared_data->idle[i] &&
+            (topology->speed(i) > speed || (topology->speed(i) == speed && i < core_id)))
+        {
+            faster++;
+        }
+    }
+    return faster;
+}
+
+// A process just arrived or finished i/o: SRTF/PSRTF preempt the core with the
+// longest remaining time if the newcomer is shorter (caller must hold shared_data->mutex)
+void readyArrived(SchedulerData *shared_data, Process *p, uint32_t current_time)
+{
+    if (shared_data->running != NULL)
+    {
+        shared_data->running->preemptFor(expectedMs(shared_data, p), current_time);
+    }
+}
+
+// Cpu time the scheduler believes `p` still needs: the known remaining time
+// (SRTF) or the predicted rest of its current burst (PSRTF)
+uint32_t expectedMs(SchedulerData *shared_data, const Process *p)
+{
+    double ms = (shared_data->predicted != NULL) ? p->getPredictedRemainingBurst()
+                                                 : p->getRemainingTime() * 1000.0;
+    return (uint32_t)(ms + 0.5);
+}
+
+// Process `p` started an i/o burst: queue it on its device (pid % devices)
+// (caller must hold shared_data->mutex)
+void ioSubmit(SchedulerData *shared_data, Process *p, uint32_t current_time)
+{
+    shared_data->io_q.push_back(p);
+    if (shared_data->devices.empty())
+    {
+        std::push_heap(shared_data->io_q.begin(), shared_data->io_q.end(), IoEndsLater());
+    }
+    else
+    {
+        shared_data->devices[p->getPid() % shared_data->devices.size()]->submit(p, current_time);
+    }
+}
+
+// Finish every i/o burst that is done by `current_time`, appending the
+// processes to `finished` if given. Without devices all bursts run in
+// parallel and io_q is a heap on their end; with devices each completes its
+// own requests.
+// (caller must hold shared_data->mutex)
+void ioComplete(SchedulerData *shared_data, uint32_t current_time, std::vector<Process*> *finished)
+{
+    std::vector<Process*>& io_q = shared_data->io_q;
+    if (shared_data->devices.empty())
+    {
+        while (!io_q.empty() && ioEnd(io_q.front()) <= current_time)
+        {
+            Process *p = io_q.front();
+            std::pop_heap(io_q.begin(), io_q.end(), IoEndsLater());
+            io_q.pop_back();
+            if (finished != NULL) finished->push_back(p);
+            ioFinished(shared_data, p, current_time);
+        }
+        return;
+    }
+    size_t i;
+    for (i = 0; i < shared_data->devices.size(); i++)
+    {
+        Process *p;
+        while ((p = shared_data->devices[i]->complete(current_time)) != NULL)
+        {
+            io_q.erase(std::find(io_q.begin(), io_q.end(), p));
+            if (finished != NULL) finished->push_back(p);
+            ioFinished(shared_data, p, current_time);
+        }
+    }
+}
+
+// Earliest time an i/o burst in progress ends (UINT32_MAX when none is)
+// (caller must hold shared_data->mutex)
+uint32_t ioNextDone(const SchedulerData *shared_data)
+{
+    uint32_t next = UINT32_MAX;
+    if (shared_data->devices.empty())
+    {
+        return shared_data->io_q.empty() ? next : ioEnd(shared_data->io_q.front());
+    }
+    size_t i;
+    for (i = 0; i < shared_data->devices.size(); i++)
+    {
+        next = std::min(next, shared_data->devices[i]->busyUntil());
+    }
+    return next;
+}
+
+// Process `p` finished an i/o burst: back to the ready queue
+// (caller must hold shared_data->mutex)
+void ioFinished(SchedulerData *shared_data, Process *p, uint32_t current_time)
+{
+    p->updateCurrentBurst();
+    startCompeting(shared_data, p, current_time);
+    p->setState(Process::State::Ready, current_time);
+    if (shared_data->mlfq_io_boost && p->getQueueLevel() > 0)
+    {
+        p->setQueueLevel(p->getQueueLevel() - 1);
+    }
+    if (shared_data->cfs != NULL) shared_data->cfs->place(p, false);
+    if (shared_data->stride != NULL) shared_data->stride->place(p);
+    readyPush(shared_data, p);
+    readyArrived(shared_data, p, current_time);
+    p->setIntoQueueTime(current_time);
+}
+
+// A cpu burst just completed: feed its length to the burst predictor
+void burstFinished(SchedulerData *shared_data, Process *p)
+{
+    if (shared_data->predicted != NULL)
+    {
+        p->observeBurst(p->getCurrentBurstTime(), shared_data->predict_alpha);
+    }
+    if (shared_data->tuner != NULL)
+    {
+        shared_data->tuner->observeBurst(p->getCurrentBurstTime());
+    }
+}
+
+// Proportional share entitlement is accrued lazily. The cpu capacity in use
+// (one core per competing process, up to the number of cores) is split among
+// the competing processes in proportion to their tickets, so every ticket is
+// entitled to the same amount: entitlement_per_ticket, advanced at each change
+// of the competing set. A process is credited its tickets times the growth of
+// that total while it competed when it stops competing.
+static void advanceEntitlement(SchedulerData *shared_data, uint32_t now)
+{
+    if (shared_data->competing_tickets == 0)
+    {
+        shared_data->entitlement_time = now;
+        return;
+    }
+    // a core thread may bring a time read before it took the mutex
+    int32_t elapsed = (int32_t)(now - shared_data->entitlement_time);
+    if (elapsed <= 0)
+    {
+        return;
+    }
+    double capacity = (double)elapsed * std::min<uint32_t>(shared_data->competing, shared_data->idle.size());
+    shared_data->entitlement_per_ticket += capacity / shared_data->competing_tickets;
+    shared_data->entitlement_time = now;
+}
+
+// Process `p` became ready (caller must hold shared_data->mutex)
+void startCompeting(SchedulerData *shared_data, Process *p, uint32_t now)
+{
+    if (!isProportionalShare(shared_data->algorithm))
+    {
+        return;
+    }
+    advanceEntitlement(shared_data, now);
+    shared_data->competing_tickets += p->getTickets();
+    shared_data->competing++;
+    p->startCompeting(shared_data->entitlement_per_ticket);
+}
+
+// Process `p` left the cpu for i/o or for good (caller must hold shared_data->mutex)
+void stopCompeting(SchedulerData *shared_data, Process *p, uint32_t now)
+{
+    if (!isProportionalShare(shared_data->algorithm))
+    {
+        return;
+    }
+    advanceEntitlement(shared_data, now);
+    shared_data->competing_tickets -= p->getTickets();
+    shared_data->competing--;
+    p->stopCompeting(shared_data->entitlement_per_ticket);
+}
+
+// MLFQ time slice grows by `mlfq_slice_factor` per level below the top
+uint32_t mlfqTimeSlice(SchedulerData *shared_data, uint8_t level)
+{
+    uint32_t slice = shared_data->time_slice;
+    uint8_t i;
+    for (i = 0; i < level; i++)
+    {
+        slice *= shared_data->mlfq_slice_factor;
+    }
+    return slice;
+}
@@ -0,0 +1,575 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "simulator.h"
+#include "scheduler.h"
+#include "checkpoint.h"
+#include "bufferedwriter.h"
+
+// Virtual time the processes are created at (0 reads as "never" in Process)
+static const uint32_t VIRTUAL_START = 1;
+static const uint32_t NEVER = UINT32_MAX;
+
+// A simulated core: the process on it, or when its last context switch ends
+typedef struct VirtualCore {
+    CoreState state;
+    Process *process;
+    const Process *previous;    // last process to leave the core (affinity)
+    uint32_t free_at;           // may dispatch from this time on
+} VirtualCore;
+
+// State of one virtual-time run
+typedef struct Simulation {
+    SchedulerData *shared_data;
+    std::vector<Process*> *processes;
+    std::vector<Process*> arrivals;     // processes not started at creation, by start time
+    size_t next_arrival;
+    std::vector<VirtualCore> cores;
+    uint32_t start;
+    uint32_t now;
+    uint32_t last_boost;
+    uint32_t half_time;
+    uint32_t end_time;
+    uint64_t events;
+    std::vector<TraceEvent> *trace;     // NULL: not traced
+    const CheckpointSpec *checkpoint;   // NULL: no checkpoints
+    uint64_t fingerprint;               // of the configuration
+    uint32_t last_checkpoint;
+    pid_t checkpoint_writer;            // child still writing the last checkpoint (0 = none)
+} Simulation;
+
+struct EarlierStart {
+    bool operator ()(const Process *p1, const Process *p2) const
+    {
+        if (p1->getStartTime() != p2->getStartTime())
+        {
+            return p1->getStartTime() < p2->getStartTime();
+        }
+        return p1->getPid() < p2->getPid();
+    }
+};
+
+// Fewest ms after which `p`, at its current run rate, has done `work` ms of work
+static uint32_t msForWork(const Process *p, uint32_t work)
+{
+    uint32_t low = 0;
+    uint32_t high = std::max(1u, work);
+    while (p->workIn(high) < work && high < NEVER / 2)
+    {
+        high *= 2;
+    }
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        if (p->workIn(mid) >= work) high = mid;
+        else low = mid + 1;
+    }
+    return low;
+}
+
+static void traceEvent(Simulation& sim, TraceKind kind, const Process *p, int core)
+{
+    if (sim.trace != NULL)
+    {
+        TraceEvent event;
+        event.time = sim.now - sim.start;
+        event.kind = kind;
+        event.pid = p->getPid();
+        event.core = core;
+        sim.trace->push_back(event);
+    }
+}
+
+static uint32_t busyCores(const Simulation& sim)
+{
+    uint32_t busy = 0;
+    size_t c;
+    for (c = 0; c < sim.cores.size(); c++)
+    {
+        if (sim.cores[c].process != NULL) busy++;
+    }
+    return busy;
+}
+
+// Everything due at sim.now, in the order of the real-time engine: the main
+// loop's work (arrivals, i/o completions, queue upkeep), then each core
+template <typename Policy>
+static void simulateEvent(Simulation& sim)
+{
+    SchedulerData *shared_data = sim.shared_data;
+    std::vector<Process*>& processes = *sim.processes;
+    uint32_t now = sim.now;
+    shared_data->virtual_now = now;
+
+    if (shared_data->tuner != NULL)
+    {
+        shared_data->time_slice = shared_data->tuner->tick(now - sim.start, readySize(shared_data), busyCores(sim),
+                                                           shared_data->switches, shared_data->time_slice);
+    }
+
+    while (sim.next_arrival < sim.arrivals.size() &&
+           sim.arrivals[sim.next_arrival]->getStartTime() <= now - sim.start)
+    {
+        traceEvent(sim, TraceArrival, sim.arrivals[sim.next_arrival], -1);
+        launchProcess(shared_data, sim.arrivals[sim.next_arrival++], now);
+        sim.events++;
+    }
+    size_t doing_io = shared_data->io_q.size();
+    std::vector<Process*> io_done;
+    ioComplete(shared_data, now, (sim.trace != NULL) ? &io_done : NULL);
+    sim.events += doing_io - shared_data->io_q.size();
+    size_t i;
+    for (i = 0; i < io_done.size(); i++)
+    {
+        traceEvent(sim, TraceIoDone, io_done[i], -1);
+    }
+    if (shared_data->mlfq != NULL && shared_data->mlfq_boost > 0 && now - sim.last_boost >= shared_data->mlfq_boost)
+    {
+        mlfqBoost(shared_data, processes);
+        sim.last_boost = now;
+    }
+
+    // processes on a core: burst done, terminated or yielding
+    size_t c;
+    for (c = 0; c < sim.cores.size(); c++)
+    {
+        VirtualCore& core = sim.cores[c];
+        Process *p = core.process;
+        if (p == NULL || now < p->getSliceStartTime())
+        {
+            continue;
+        }
+        p->updateProcess<Policy>(now);
+        uint32_t ran = now - p->getSliceStartTime();
+        if (p->getRemainingTime() <= 0){
+            terminateCore<Policy>(shared_data, core.state, p, ran, now);
+            traceEvent(sim, TraceTerminate, p, c);
+        }
+        else if (p->getBurstTimeElapsed() >= p->getCurrentBurstTime()){
+            blockCore<Policy>(shared_data, core.state, p, ran, now);
+            traceEvent(sim, TraceBlock, p, c);
+        }
+        else if (Policy::preemptible && Policy::shouldYield(shared_data, core.state, p, ran)){
+            yieldCore<Policy>(shared_data, core.state, p, ran, now);
+            traceEvent(sim, TraceYield, p, c);
+        }
+        else {
+            continue;
+        }
+        core.previous = p;
+        core.process = NULL;
+        core.free_at = now + shared_data->context_switch;
+        sim.events++;
+    }
+
+    // idle cores take work; repeat while that changes anything, since a
+    // placement policy may leave a process for a core later in the order
+    bool dispatched = true;
+    while (dispatched)
+    {
+        dispatched = false;
+        for (c = 0; c < sim.cores.size(); c++)
+        {
+            VirtualCore& core = sim.cores[c];
+            if (core.process != NULL || core.free_at > now)
+            {
+                continue;
+            }
+            uint32_t migration;
+            core.process = dispatchCore<Policy>(shared_data, core.state, core.previous, now, &migration);
+            if (core.process != NULL)
+            {
+                dispatched = true;
+                sim.events++;
+                traceEvent(sim, TraceDispatch, core.process, c);
+            }
+        }
+    }
+
+    if (shared_data->terminated.size() >= processes.size() / 2 && sim.half_time == 0)
+    {
+        sim.half_time = now;
+    }
+    if (shared_data->terminated.size() == processes.size())
+    {
+        shared_data->all_terminated = true;
+        sim.end_time = now;
+    }
+}
+
+// First time after sim.now at which the process on `core` finishes its burst
+// or its policy wants the core back. Whether a policy yields only changes at
+// events or grows more likely as time passes (slices run out, waiting
+// processes age), so the yield point is found by bisection.
+template <typename Policy>
+static uint32_t coreEvent(Simulation& sim, VirtualCore& core)
+{
+    SchedulerData *shared_data = sim.shared_data;
+    Process *p = core.process;
+    uint32_t slice_start = p->getSliceStartTime();
+    uint32_t done = slice_start + msForWork(p, p->getBurstRemaining());
+    uint32_t from = std::max(sim.now, slice_start);
+    if (!Policy::preemptible || from >= done)
+    {
+        return done;
+    }
+    shared_data->virtual_now = done - 1;
+    if (!Policy::shouldYield(shared_data, core.state, p, done - 1 - slice_start))
+    {
+        shared_data->virtual_now = sim.now;
+        return done;
+    }
+    uint32_t low = from;
+    uint32_t high = done - 1;
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        shared_data->virtual_now = mid;
+        if (Policy::shouldYield(shared_data, core.state, p, mid - slice_start)) high = mid;
+        else low = mid + 1;
+    }
+    shared_data->virtual_now = sim.now;
+    return low;
+}
+
+// Time of the next event after everything due at sim.now has been handled
+template <typename Policy>
+static uint32_t nextEvent(Simulation& sim)
+{
+    SchedulerData *shared_data = sim.shared_data;
+    uint32_t next = NEVER;
+    size_t i;
+    if (sim.next_arrival < sim.arrivals.size())
+    {
+        next = std::min(next, sim.start + sim.arrivals[sim.next_arrival]->getStartTime());
+    }
+    next = std::min(next, ioNextDone(shared_data));
+    if (shared_data->mlfq != NULL && shared_data->mlfq_boost > 0)
+    {
+        next = std::min(next, sim.last_boost + shared_data->mlfq_boost);
+    }
+    if (shared_data->tuner != NULL)
+    {
+        next = std::min(next, sim.start + shared_data->tuner->nextAdjustment());
+    }
+
+    bool waiting_core = false;
+    for (i = 0; i < sim.cores.size(); i++)
+    {
+        VirtualCore& core = sim.cores[i];
+        if (core.process != NULL)
+        {
+            next = std::min(next, coreEvent<Policy>(sim, core));
+        }
+        else if (core.free_at > sim.now)
+        {
+            next = std::min(next, core.free_at);
+        }
+        else
+        {
+            waiting_core = true;
+        }
+    }
+    // an idle core passed over waiting work: NUMA balance lets it take a
+    // remote process once that has waited numa_steal ms, else look again in 1 ms
+    if (waiting_core && Policy::size(shared_data) > 0)
+    {
+        uint32_t retry = sim.now + 1;
+        if (shared_data->numa_policy == NumaPolicy::NumaBalance && !shared_data->ready_queue.empty())
+        {
+            retry = std::max(retry, shared_data->ready_queue.front()->getIntoQueueTime() + shared_data->numa_steal);
+        }
+        next = std::min(next, retry);
+    }
+    return next;
+}
+
+// The state the run continues from at sim.now, before that time's events
+static std::string simulationImage(const Simulation& sim)
+{
+    const std::vector<Process*>& processes = *sim.processes;
+    CheckpointWriter out(processes);
+    size_t i;
+    out.putU32(processes.size());
+    for (i = 0; i < processes.size(); i++)
+    {
+        processes[i]->save(out);
+    }
+    out.putU32(sim.next_arrival);
+    out.putU32(sim.start);
+    out.putU32(sim.now);
+    out.putU32(sim.last_boost);
+    out.putU32(sim.half_time);
+    out.putU32(sim.end_time);
+    out.putU64(sim.events);
+    out.putU32(sim.cores.size());
+    for (i = 0; i < sim.cores.size(); i++)
+    {
+        out.putU32(sim.cores[i].state.slice);
+        out.putProcess(sim.cores[i].process);
+        out.putProcess(sim.cores[i].previous);
+        out.putU32(sim.cores[i].free_at);
+    }
+    saveSchedulerData(sim.shared_data, out);
+    return out.image();
+}
+
+// Into a simulation freshly set up from the same configuration, with no
+// process launched yet
+static bool restoreSimulation(Simulation& sim, const std::string& image)
+{
+    std::vector<Process*>& processes = *sim.processes;
+    CheckpointReader in(image, processes);
+    size_t i;
+    if (in.getU32() != processes.size())
+    {
+        return false;
+    }
+    for (i = 0; i < processes.size(); i++)
+    {
+        processes[i]->load(in);
+    }
+    sim.next_arrival = in.getU32();
+    sim.start = in.getU32();
+    sim.now = in.getU32();
+    sim.last_boost = in.getU32();
+    sim.half_time = in.getU32();
+    sim.end_time = in.getU32();
+    sim.events = in.getU64();
+    if (in.getU32() != sim.cores.size() || sim.next_arrival > sim.arrivals.size())
+    {
+        return false;
+    }
+    for (i = 0; i < sim.cores.size(); i++)
+    {
+        sim.cores[i].state.slice = in.getU32();
+        sim.cores[i].process = in.getProcess();
+        sim.cores[i].previous = in.getProcess();
+        sim.cores[i].free_at = in.getU32();
+    }
+    return loadSchedulerData(sim.shared_data, in) && in.atEnd();
+}
+
+// Collects the child writing the last checkpoint; false while it is still
+// writing and `wait` is not set
+static bool reapCheckpointWriter(Simulation& sim, bool wait)
+{
+    if (sim.checkpoint_writer == 0)
+    {
+        return true;
+    }
+    int status;
+    pid_t done = waitpid(sim.checkpoint_writer, &status, wait ? 0 : WNOHANG);
+    if (done == 0)
+    {
+        return false;
+    }
+    if (done < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        std::cerr << "Warning: could not write checkpoint " << sim.checkpoint->file << std::endl;
+    }
+    sim.checkpoint_writer = 0;
+    return true;
+}
+
+// Snapshot at sim.now without stopping the run: a forked child serializes its
+// copy-on-write view of the state and replaces the checkpoint file, while the
+// parent carries on. If fork fails the checkpoint is written in place.
+static void takeCheckpoint(Simulation& sim)
+{
+    sim.last_checkpoint = sim.now;
+    if (!reapCheckpointWriter(sim, false))
+    {
+        return;
+    }
+    pid_t child = fork();
+    if (child == 0)
+    {
+        bool written = writeCheckpointFile(sim.checkpoint->file, sim.fingerprint, simulationImage(sim));
+        _exit(written ? 0 : 1);
+    }
+    if (child > 0)
+    {
+        sim.checkpoint_writer = child;
+    }
+    else if (!writeCheckpointFile(sim.checkpoint->file, sim.fingerprint, simulationImage(sim)))
+    {
+        std::cerr << "Warning: could not write checkpoint " << sim.checkpoint->file << std::endl;
+    }
+}
+
+template <typename Policy>
+static void simulateWith(Simulation& sim)
+{
+    SchedulerData *shared_data = sim.shared_data;
+    while (!shared_data->all_terminated)
+    {
+        if (sim.checkpoint != NULL && sim.now - sim.last_checkpoint >= sim.checkpoint->every)
+        {
+            takeCheckpoint(sim);
+        }
+        simulateEvent<Policy>(sim);
+        if (shared_data->all_terminated)
+        {
+            break;
+        }
+        uint32_t next = nextEvent<Policy>(sim);
+        if (next == NEVER)
+        {
+            std::cerr << "Error: simulation stalled at " << sim.now - sim.start << " ms" << std::endl;
+            sim.end_time = sim.now;
+            break;
+        }
+        sim.now = next;
+    }
+}
+
+// Runs the simulation with the policy type of the configured algorithm
+struct SimulationRunner {
+    typedef void result_type;
+    Simulation *sim;
+
+    template <typename Policy>
+    void run()
+    {
+        simulateWith<Policy>(*sim);
+    }
+};
+
+SimulationResult simulate(const SchedulerConfig *config, std::vector<Process*>& processes,
+                          std::vector<TraceEvent> *trace, const CheckpointSpec *checkpoint)
+{
+    std::chrono::steady_clock::time_point began = std::chrono::steady_clock::now();
+    Simulation sim;
+    sim.shared_data = createSchedulerData(config);
+    sim.shared_data->virtual_clock = true;
+    sim.shared_data->virtual_now = VIRTUAL_START;
+    sim.processes = &processes;
+    sim.next_arrival = 0;
+    sim.start = VIRTUAL_START;
+    sim.now = VIRTUAL_START;
+    sim.last_boost = VIRTUAL_START;
+    sim.half_time = 0;
+    sim.end_time = 0;
+    sim.events = 0;
+    sim.trace = trace;
+    sim.checkpoint = (checkpoint != NULL && !checkpoint->file.empty()) ? checkpoint : NULL;
+    sim.fingerprint = (checkpoint != NULL) ? configFingerprint(config) : 0;
+    sim.checkpoint_writer = 0;
+    bool restoring = (checkpoint != NULL && !checkpoint->restore.empty());
+
+    int i;
+    for (i = 0; i < config->num_processes; i++)
+    {
+        Process *p = createProcess(config, i, sim.start);
+        processes.push_back(p);
+        if (p->getState() != Process::State::Ready)
+        {
+            sim.arrivals.push_back(p);
+        }
+        else if (!restoring)
+        {
+            launchProcess(sim.shared_data, p, sim.start);
+        }
+    }
+    std::sort(sim.arrivals.begin(), sim.arrivals.end(), EarlierStart());
+    sim.cores.resize(config->cores);
+    for (i = 0; i < config->cores; i++)
+    {
+        sim.cores[i].state.core = i;
+        sim.cores[i].state.slice = 0;
+        sim.cores[i].process = NULL;
+        sim.cores[i].previous = NULL;
+        sim.cores[i].free_at = sim.start;
+    }
+
+    SimulationResult result;
+    if (restoring)
+    {
+        std::string image;
+        if (!readCheckpointFile(checkpoint->restore, sim.fingerprint, &image, &result.error))
+        {
+            deleteSchedulerData(sim.shared_data);
+            return result;
+        }
+        if (!restoreSimulation(sim, image))
+        {
+            result.error = checkpoint->restore + " does not match the configuration";
+            deleteSchedulerData(sim.shared_data);
+            return result;
+        }
+        std::cerr << "Restored " << checkpoint->restore << " at " << sim.now - sim.start << " ms" << std::endl;
+    }
+    sim.last_checkpoint = sim.now;
+
+    std::chrono::steady_clock::time_point set_up = std::chrono::steady_clock::now();
+    SimulationRunner runner;
+    runner.sim = &sim;
+    withPolicy(config->algorithm, runner);
+    reapCheckpointWriter(sim, true);
+
+    result.summary = summarizeRun(processes, sim.start, sim.half_time, sim.end_time);
+    finishSummary(sim.shared_data, processes, sim.end_time, &result.summary);
+    result.start = sim.start;
+    result.events = sim.events;
+    deleteSchedulerData(sim.shared_data);
+    result.setup_seconds = std::chrono::duration<double>(set_up - began).count();
+    result.run_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - set_up).count();
+    return result;
+}
+
+// The trace as CSV: time_ms,event,pid,core (core empty when not on one)
+bool writeTrace(const std::string& filename, const std::vector<TraceEvent>& trace)
+{
+    BufferedWriter out(filename);
+    if (!out.isOpen())
+    {
+        return false;
+    }
+    out.put("time_ms,event,pid,core\n");
+    size_t i;
+    for (i = 0; i < trace.size(); i++)
+    {
+        const TraceEvent& event = trace[i];
+        out.putUnsigned(event.time).put(',').put(traceKindToString(event.kind)).put(',').putUnsigned(event.pid);
+        out.put(',');
+        if (event.core >= 0)
+        {
+            out.putUnsigned(event.core);
+        }
+        out.put('\n');
+    }
+    return out.flush();
+}
+
+std::string traceKindToString(TraceKind kind)
+{
+    std::string str;
+    switch (kind)
+    {
+        case TraceKind::TraceArrival:
+            str = "arrive";
+            break;
+        case TraceKind::TraceIoDone:
+            str = "io_done";
+            break;
+        case TraceKind::TraceDispatch:
+            str = "dispatch";
+            break;
+        case TraceKind::TraceYield:
+            str = "yield";
+            break;
+        case TraceKind::TraceBlock:
+            str = "block";
+            break;
+        case TraceKind::TraceTerminate:
+            str = "terminate";
+            break;
+        default:
+            str = "unknown";
+            break;
+    }
+    return str;
+}
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <cmath>
+#include "slicetuner.h"
+
+static const size_t BURST_WINDOW = 64;
+
+SliceTuner::SliceTuner(const SchedulerConfig *config)
+    : mode(config->rr_adaptive), target_overhead(config->rr_target_overhead),
+      target_response(config->rr_target_response), interval(config->rr_adapt_interval),
+      min_slice(config->rr_min_slice), max_slice(config->rr_max_slice),
+      context_switch(config->context_switch), cores(config->cores),
+      window_start(0), last_tick(0), ready_area(0), busy_area(0), switches_before(0), next_burst(0)
+{
+}
+
+void SliceTuner::observeBurst(uint32_t length)
+{
+    if (bursts.size() < BURST_WINDOW)
+    {
+        bursts.push_back(length);
+    }
+    else
+    {
+        bursts[next_burst] = length;
+        next_burst = (next_burst + 1) % BURST_WINDOW;
+    }
+}
+
+uint32_t SliceTuner::burstPercentile(double q) const
+{
+    if (bursts.empty())
+    {
+        return 0;
+    }
+    std::vector<uint32_t> sorted(bursts);
+    std::sort(sorted.begin(), sorted.end());
+    size_t rank = (size_t)std::ceil(q * sorted.size());
+    return sorted[(rank > 0) ? rank - 1 : 0];
+}
+
+uint32_t SliceTuner::tick(uint32_t now, size_t ready, uint32_t busy_cores, uint64_t switches, uint32_t slice)
+{
+    uint32_t elapsed = now - last_tick;
+    ready_area += (uint64_t)ready * elapsed;
+    busy_area += (uint64_t)busy_cores * elapsed;
+    last_tick = now;
+    if (now - window_start < interval)
+    {
+        return slice;
+    }
+
+    uint32_t window = now - window_start;
+    double mean_ready = (double)ready_area / window;
+    double switch_ms = (double)(switches - switches_before) * context_switch;
+    double overhead = (busy_area + switch_ms > 0) ? switch_ms / (busy_area + switch_ms) : 0.0;
+    uint32_t burst_p80 = burstPercentile(0.8);
+
+    double proposed = slice;
+    if (mode == SliceMode::SliceOverhead && overhead > 0)
+    {
+        proposed = slice * overhead / target_overhead;
+        if (proposed > slice && burst_p80 > 0)
+        {
+            proposed = std::min(proposed, (double)std::max(slice, burst_p80));
+        }
+    }
+    else if (mode == SliceMode::SliceResponse)
+    {
+        if (mean_ready > 0.5)
+        {
+            proposed = target_response * (double)cores / mean_ready - context_switch;
+        }
+        else if (burst_p80 > 0)
+        {
+            // nobody is waiting: let most bursts finish in one slice
+            proposed = burst_p80;
+        }
+    }
+    proposed = std::sqrt(slice * std::max(proposed, 1.0));
+    uint32_t new_slice = std::max(min_slice, std::min(max_slice, (uint32_t)std::lround(proposed)));
+
+    if (new_slice != slice)
+    {
+        SliceAdjustment adjustment;
+        adjustment.time = now;
+        adjustment.old_slice = slice;
+        adjustment.new_slice = new_slice;
+        adjustment.ready = mean_ready;
+        adjustment.overhead = overhead;
+        adjustment.burst_p80 = burst_p80;
+        log.push_back(adjustment);
+    }
+
+    window_start = now;
+    ready_area = 0;
+    busy_area = 0;
+    switches_before = switches;
+    return new_slice;
+}
+
+uint32_t SliceTuner::nextAdjustment() const
+{
+    return window_start + interval;
+}
+
+const std::vector<SliceAdjustment>& SliceTuner::adjustments() const
+{
+    return log;
+}
+
+void SliceTuner::save(CheckpointWriter& out) const
+{
+    size_t i;
+    out.putU32(window_start);
+    out.putU32(last_tick);
+    out.putU64(ready_area);
+    out.putU64(busy_area);
+    out.putU64(switches_before);
+    out.putU32(bursts.size());
+    for (i = 0; i < bursts.size(); i++)
+    {
+        out.putU32(bursts[i]);
+    }
+    out.putU32(next_burst);
+    out.putU32(log.size());
+    for (i = 0; i < log.size(); i++)
+    {
+        out.putU32(log[i].time);
+        out.putU32(log[i].old_slice);
+        out.putU32(log[i].new_slice);
+        out.putDouble(log[i].ready);
+        out.putDouble(log[i].overhead);
+        out.putU32(log[i].burst_p80);
+    }
+}
+
+void SliceTuner::load(CheckpointReader& in)
+{
+    uint32_t n, i;
+    window_start = in.getU32();
+    last_tick = in.getU32();
+    ready_area = in.getU64();
+    busy_area = in.getU64();
+    switches_before = in.getU64();
+    n = in.getU32();
+    bursts.clear();
+    for (i = 0; i < n && in.ok(); i++)
+    {
+        bursts.push_back(in.getU32());
+    }
+    next_burst = in.getU32();
+    n = in.getU32();
+    log.clear();
+    for (i = 0; i < n && in.ok(); i++)
+    {
+        SliceAdjustment adjustment;
+        adjustment.time = in.getU32();
+        adjustment.old_slice = in.getU32();
+        adjustment.new_slice = in.getU32();
+        adjustment.ready = in.getDouble();
+        adjustment.overhead = in.getDouble();
+        adjustment.burst_p80 = in.getU32();
+        log.push_back(adjustment);
+    }
+}
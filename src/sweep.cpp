@@ -0,0 +1,225 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include "sweep.h"
+#include "simulator.h"
+#include "bufferedwriter.h"
+
+// Values to sweep, or the base configuration's value
+template <typename T>
+static std::vector<T> valuesOr(const std::vector<T>& values, T base)
+{
+    return values.empty() ? std::vector<T>(1, base) : values;
+}
+
+// Worker: simulate points until none are left
+static void sweepWorker(const SchedulerConfig *base, std::vector<SweepPoint> *points, std::atomic<size_t> *next)
+{
+    size_t i;
+    while ((i = (*next)++) < points->size())
+    {
+        SweepPoint& point = (*points)[i];
+        SchedulerConfig *config = deriveConfig(base, point.algorithm, point.cores, point.time_slice,
+                                               point.context_switch);
+        std::vector<Process*> processes;
+        SimulationResult result = simulate(config, processes);
+        point.summary = result.summary;
+        point.events = result.events;
+        size_t p;
+        for (p = 0; p < processes.size(); p++)
+        {
+            delete processes[p];
+        }
+        deleteConfig(config);
+    }
+}
+
+std::vector<SweepPoint> runSweep(const SchedulerConfig *base, const SweepSpec& spec)
+{
+    std::vector<ScheduleAlgorithm> algorithms = valuesOr(spec.algorithms, base->algorithm);
+    std::vector<uint32_t> cores = valuesOr(spec.cores, (uint32_t)base->cores);
+    std::vector<uint32_t> slices = valuesOr(spec.time_slices, base->time_slice);
+    std::vector<uint32_t> switches = valuesOr(spec.context_switches, base->context_switch);
+
+    std::vector<SweepPoint> points;
+    size_t a, c, s, w;
+    for (a = 0; a < algorithms.size(); a++)
+    {
+        for (c = 0; c < cores.size(); c++)
+        {
+            for (s = 0; s < slices.size(); s++)
+            {
+                for (w = 0; w < switches.size(); w++)
+                {
+                    SweepPoint point = SweepPoint();
+                    point.algorithm = algorithms[a];
+                    point.cores = cores[c];
+                    point.time_slice = slices[s];
+                    point.context_switch = switches[w];
+                    points.push_back(point);
+                }
+            }
+        }
+    }
+
+    uint32_t jobs = (spec.jobs > 0) ? spec.jobs : std::max(1u, std::thread::hardware_concurrency());
+    jobs = std::min<size_t>(jobs, points.size());
+    std::atomic<size_t> next(0);
+    std::chrono::steady_clock::time_point began = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    uint32_t j;
+    for (j = 0; j < jobs; j++)
+    {
+        workers.push_back(std::thread(sweepWorker, base, &points, &next));
+    }
+    for (j = 0; j < jobs; j++)
+    {
+        workers[j].join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+    std::cerr << "Swept " << points.size() << " points on " << jobs << " threads in " << seconds << " s" << std::endl;
+    return points;
+}
+
+void printSweep(const std::vector<SweepPoint>& points)
+{
+    printf("| Algorithm | Cores | Slice | Switch | Runtime | CPU Util | Throughput | Turnaround |  Wait  | Wait p99 | Switches | Overhead |\n");
+    printf("+-----------+-------+-------+--------+---------+----------+------------+------------+--------+----------+----------+----------+\n");
+    size_t i;
+    for (i = 0; i < points.size(); i++)
+    {
+        const SweepPoint& p = points[i];
+        const RunSummary& s = p.summary;
+        printf("| %9s | %5u | %5u | %6u | %7.3lf | %7.1lf%% | %10.3lf | %10.3lf | %6.3lf | %8.3lf | %8lu | %7.2lf%% |\n",
+               algorithmToString(p.algorithm).c_str(), p.cores, p.time_slice, p.context_switch, s.runtime,
+               s.cpu_percent, s.overall_throughput, s.turn_avg, s.wait_avg, s.wait_p99,
+               (unsigned long)s.context_switches, 100.0 * s.switch_overhead);
+    }
+}
+
+// The metrics of a comparison, in column order
+static void comparisonMetrics(const RunSummary& s, double *values)
+{
+    values[0] = s.runtime;
+    values[1] = s.cpu_percent;
+    values[2] = s.overall_throughput;
+    values[3] = s.turn_avg;
+    values[4] = s.wait_avg;
+    values[5] = s.wait_p99;
+    values[6] = (double)s.context_switches;
+    values[7] = 100.0 * s.switch_overhead;
+    values[8] = s.migrations;
+    values[9] = s.deadlines.misses;
+}
+
+void printComparison(const std::vector<SweepPoint>& points, size_t baseline)
+{
+    const char *headers[] = {"Runtime s", "CPU Util %", "Throughput", "Turnaround s", "Wait s", "Wait p99 s",
+                             "Switches", "Overhead %", "Migrations", "DL Misses"};
+    const size_t num_metrics = sizeof(headers) / sizeof(headers[0]);
+    double base[num_metrics], values[num_metrics];
+    comparisonMetrics(points[baseline].summary, base);
+    size_t i, m;
+    printf("Relative to %s\n", algorithmToString(points[baseline].algorithm).c_str());
+    printf("| Algorithm |");
+    for (m = 0; m < num_metrics; m++)
+    {
+        printf(" %16s |", headers[m]);
+    }
+    printf("\n+-----------+");
+    for (m = 0; m < num_metrics; m++)
+    {
+        printf("------------------+");
+    }
+    printf("\n");
+    for (i = 0; i < points.size(); i++)
+    {
+        comparisonMetrics(points[i].summary, values);
+        printf("| %9s |", algorithmToString(points[i].algorithm).c_str());
+        for (m = 0; m < num_metrics; m++)
+        {
+            printf(" %9.3lf", values[m]);
+            if (i == baseline)
+            {
+                printf("    base |");
+            }
+            else if (base[m] != 0 && std::isfinite(base[m]) && std::isfinite(values[m]))
+            {
+                printf(" %+6.1lf%% |", 100.0 * (values[m] - base[m]) / std::fabs(base[m]));
+            }
+            else
+            {
+                printf(" %7s |", (values[m] == base[m]) ? "+0.0%" : "n/a");
+            }
+        }
+        printf("\n");
+    }
+}
+
+bool writeSweep(ReportFormat format, const std::string& filename, const std::vector<SweepPoint>& points)
+{
+    BufferedWriter out(filename);
+    if (!out.isOpen())
+    {
+        return false;
+    }
+    bool json = (format == ReportFormat::JsonReport);
+    const char *names[] = {"runtime_s", "cpu_utilization_pct", "throughput_overall", "avg_turnaround_s",
+                           "avg_wait_s", "wait_p99_s", "switch_overhead"};
+    const size_t num_metrics = sizeof(names) / sizeof(names[0]);
+    size_t i, m;
+    if (json)
+    {
+        out.put("[");
+    }
+    else
+    {
+        out.put("algorithm,cores,time_slice,context_switch");
+        for (m = 0; m < num_metrics; m++)
+        {
+            out.put(',').put(names[m]);
+        }
+        out.put(",context_switches,migrations,events\n");
+    }
+    for (i = 0; i < points.size(); i++)
+    {
+        const SweepPoint& p = points[i];
+        const RunSummary& s = p.summary;
+        double metrics[] = {s.runtime, s.cpu_percent, s.overall_throughput, s.turn_avg, s.wait_avg,
+                            s.wait_p99, s.switch_overhead};
+        if (json)
+        {
+            out.put(i == 0 ? "\n  " : ",\n  ");
+            out.put("{\"algorithm\": ").putJsonString(algorithmToString(p.algorithm));
+            out.put(", \"cores\": ").putUnsigned(p.cores);
+            out.put(", \"time_slice\": ").putUnsigned(p.time_slice);
+            out.put(", \"context_switch\": ").putUnsigned(p.context_switch);
+            for (m = 0; m < num_metrics; m++)
+            {
+                out.put(", \"").put(names[m]).put("\": ");
+                out.putMetric(metrics[m], true);
+            }
+            out.put(", \"context_switches\": ").putUnsigned(s.context_switches);
+            out.put(", \"migrations\": ").putUnsigned(s.migrations);
+            out.put(", \"events\": ").putUnsigned(p.events).put('}');
+        }
+        else
+        {
+            out.put(algorithmToString(p.algorithm)).put(',').putUnsigned(p.cores).put(',');
+            out.putUnsigned(p.time_slice).put(',').putUnsigned(p.context_switch);
+            for (m = 0; m < num_metrics; m++)
+            {
+                out.put(',');
+                out.putMetric(metrics[m], false);
+            }
+            out.put(',').putUnsigned(s.context_switches).put(',').putUnsigned(s.migrations);
+            out.put(',').putUnsigned(p.events).put('\n');
+        }
+    }
+    if (json)
+    {
+        out.put("\n]\n");
+    }
+    return out.flush();
+}
@@ -0,0 +1,138 @@
+#include <cstdio>
+#include "timeseries.h"
+
+TimeSeries::TimeSeries(uint32_t interval, uint32_t capacity)
+    : interval(interval), samples(capacity), head(0), count(0), dropped(0)
+{
+    window_start = 0;
+    completed_before = 0;
+    last_completed = 0;
+    ticks = 0;
+    ready_sum = 0;
+    io_sum = 0;
+    busy_sum = 0;
+    ready_max = 0;
+    last_ready = 0;
+    last_io = 0;
+    last_busy = 0;
+}
+
+// Store the current window and start a new one at `end_time`
+void TimeSeries::closeWindow(uint32_t end_time)
+{
+    TimeSample s;
+    s.window_start = window_start;
+    s.window_length = end_time - window_start;
+    s.completions = last_completed - completed_before;
+    if (ticks > 0)
+    {
+        s.ready_depth = (double)ready_sum / ticks;
+        s.max_ready_depth = ready_max;
+        s.io_depth = (double)io_sum / ticks;
+        s.busy_cores = (double)busy_sum / ticks;
+    }
+    else
+    {
+        // no observation fell inside this window: carry the last known state forward
+        s.ready_depth = last_ready;
+        s.max_ready_depth = last_ready;
+        s.io_depth = last_io;
+        s.busy_cores = last_busy;
+    }
+
+    if (count < samples.size())
+    {
+        samples[(head + count) % samples.size()] = s;
+        count++;
+    }
+    else
+    {
+        samples[head] = s;
+        head = (head + 1) % samples.size();
+        dropped++;
+    }
+
+    window_start = end_time;
+    completed_before = last_completed;
+    ticks = 0;
+    ready_sum = 0;
+    io_sum = 0;
+    busy_sum = 0;
+    ready_max = 0;
+}
+
+void TimeSeries::observe(uint32_t now, uint32_t ready, uint32_t io, uint32_t busy, uint32_t completed)
+{
+    while (now >= window_start + interval)
+    {
+        closeWindow(window_start + interval);
+    }
+    ticks++;
+    ready_sum += ready;
+    io_sum += io;
+    busy_sum += busy;
+    if (ready > ready_max) ready_max = ready;
+    last_ready = ready;
+    last_io = io;
+    last_busy = busy;
+    last_completed = completed;
+}
+
+// Close the final (possibly partial) window
+void TimeSeries::finish(uint32_t now)
+{
+    while (now >= window_start + interval)
+    {
+        closeWindow(window_start + interval);
+    }
+    if (now > window_start || ticks > 0 || last_completed != completed_before)
+    {
+        closeWindow(now);
+    }
+}
+
+size_t TimeSeries::size() const
+{
+    return count;
+}
+
+uint64_t TimeSeries::droppedWindows() const
+{
+    return dropped;
+}
+
+const TimeSample& TimeSeries::at(size_t i) const
+{
+    return samples[(head + i) % samples.size()];
+}
+
+bool TimeSeries::writeCsv(const std::string& filename, uint8_t cores) const
+{
+    FILE *file = fopen(filename.c_str(), "w");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    if (dropped > 0)
+    {
+        fprintf(file, "# %llu earlier windows were overwritten (ring buffer full)\n",
+                (unsigned long long)dropped);
+    }
+    fprintf(file, "window_start_ms,window_ms,completions,throughput_per_s,"
+                  "ready_depth_avg,ready_depth_max,io_depth_avg,busy_cores_avg,utilization_pct\n");
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        const TimeSample& s = at(i);
+        double seconds = s.window_length / 1000.0;
+        double throughput = (seconds > 0) ? s.completions / seconds : 0.0;
+        double utilization = (cores > 0) ? (s.busy_cores / cores) * 100.0 : 0.0;
+        fprintf(file, "%u,%u,%u,%.3lf,%.2lf,%u,%.2lf,%.2lf,%.1lf\n",
+                s.window_start, s.window_length, s.completions, throughput,
+                s.ready_depth, s.max_ready_depth, s.io_depth, s.busy_cores, utilization);
+    }
+
+    fclose(file);
+    return true;
+}
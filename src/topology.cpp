@@ -0,0 +1,58 @@
+#include "topology.h"
+
+Topology::Topology(const SchedulerConfig *config)
+    : nodes(config->numa_nodes), cores_per_node(config->numa_cores_per_node),
+      distance(config->numa_distance), rates(config->numa_nodes * config->numa_nodes),
+      speeds(config->core_speeds), stretch(config->numa_stretch)
+{
+    uint32_t home, node;
+    for (home = 0; home < nodes; home++)
+    {
+        double local = distance[home * nodes + home];
+        for (node = 0; node < nodes; node++)
+        {
+            double relative = distance[home * nodes + node] / local;
+            double factor = 1.0 + stretch * std::max(0.0, relative - 1.0);
+            rates[home * nodes + node] = 1.0 / factor;
+        }
+    }
+}
+
+uint8_t Topology::numNodes() const
+{
+    return nodes;
+}
+
+// Cores are numbered node by node; any extra cores belong to the last node
+uint8_t Topology::nodeOf(uint8_t core) const
+{
+    return std::min<uint32_t>(core / cores_per_node, nodes - 1);
+}
+
+bool Topology::isLocal(uint8_t home, uint8_t core) const
+{
+    return nodeOf(core) == home;
+}
+
+double Topology::speed(uint8_t core) const
+{
+    return speeds[core];
+}
+
+bool Topology::isHeterogeneous() const
+{
+    size_t i;
+    for (i = 1; i < speeds.size(); i++)
+    {
+        if (speeds[i] != speeds[0])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+double Topology::rate(uint8_t home, uint8_t core) const
+{
+    return speeds[core] * rates[home * nodes + nodeOf(core)];
+}